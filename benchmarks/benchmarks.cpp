@@ -0,0 +1,584 @@
+/********************************************************************************
+ * Copyright (c) 2020-2026 Slick Quant LLC
+ * All rights reserved
+ *
+ * This file is part of the SlickQueue. Redistribution and use in source and
+ * binary forms, with or without modification, are permitted exclusively under
+ * the terms of the MIT license which is available at
+ * https://github.com/SlickQuant/slick-queue/blob/main/LICENSE
+ *
+ ********************************************************************************/
+
+// Micro benchmarks for SlickQueue.
+//
+// Usage: slick-queue-bench [scenario ...]
+// Runs every scenario when none is given. Numbers are wall-clock throughput of the
+// whole run and are only meaningful relative to each other on the same machine.
+
+#include <slick/queue.h>
+#include <slick/byte_queue.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+using namespace slick;
+
+namespace {
+
+struct Message {
+    uint64_t sequence;
+    uint64_t payload[3];
+};
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+void print_result(const char* scenario, const std::string& config, uint64_t messages, double seconds) {
+    std::printf("%-24s %-40s %10.2f Mmsg/s\n", scenario, config.c_str(), messages / seconds / 1e6);
+}
+
+// Producers publish messages_per_producer each, every consumer reads the whole stream with
+// its own cursor. Returns elapsed seconds until the last consumer caught up. A consumer also
+// stops once every producer finished and nothing is left to read: in lossy mode a producer
+// descheduled between reserve() and publish() can be lapped, and its late publish leaves a
+// slot behind the cursor for good. Each producer thread runs produce(queue).
+template<typename Queue, typename Produce>
+double run_mpmc_with(Queue& queue, int producers, int consumers, uint64_t messages_per_producer, Produce produce) {
+    const uint64_t total = messages_per_producer * producers;
+    std::atomic<int> ready{ 0 };
+    std::atomic<int> producing{ producers };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> threads;
+
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            uint64_t cursor = 0;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {}
+            uint64_t checksum = 0;
+            while (cursor < total) {
+                bool done = producing.load(std::memory_order_acquire) == 0;
+                auto [msg, n] = queue.read(cursor);
+                if (msg) {
+                    checksum += msg->sequence;
+                } else if (done) {
+                    break;
+                }
+            }
+            if (checksum == 1) {
+                std::printf("unreachable\n");
+            }
+        });
+    }
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&]() {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {}
+            produce(queue);
+            producing.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    while (ready.load() != producers + consumers) {}
+    auto start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    return seconds_since(start);
+}
+
+// run_mpmc_with() where producers reserve() and publish() one message at a time, or go
+// through make_producer(producer_block) when it is non-zero.
+template<typename Queue>
+double run_mpmc(Queue& queue, int producers, int consumers, uint64_t messages_per_producer, uint32_t producer_block = 0) {
+    return run_mpmc_with(queue, producers, consumers, messages_per_producer, [&](Queue& q) {
+        if (producer_block > 0) {
+            auto producer = q.make_producer(producer_block);
+            for (uint64_t i = 0; i < messages_per_producer; ++i) {
+                auto index = producer.reserve();
+                producer[index]->sequence = index;
+                producer.publish(index);
+            }
+        } else {
+            for (uint64_t i = 0; i < messages_per_producer; ++i) {
+                auto index = q.reserve();
+                q[index]->sequence = index;
+                q.publish(index);
+            }
+        }
+    });
+}
+
+void bench_mpmc_slot_mapping() {
+    constexpr uint64_t messages_per_producer = 2'000'000;
+    const struct {
+        const char* name;
+        slot_mapping mapping;
+    } mappings[] = {
+        { "linear", slot_mapping::linear },
+        { "padded", slot_mapping::padded },
+        { "swizzled", slot_mapping::swizzled },
+    };
+    for (auto [producers, consumers] : { std::pair{ 1, 1 }, std::pair{ 2, 2 }, std::pair{ 4, 2 } }) {
+        for (auto& m : mappings) {
+            SlickQueue<Message> queue(1u << 16, queue_options{ .mapping = m.mapping });
+            double seconds = run_mpmc(queue, producers, consumers, messages_per_producer);
+            print_result("mpmc_slot_mapping",
+                std::string(m.name) + " " + std::to_string(producers) + "P/" + std::to_string(consumers) + "C",
+                messages_per_producer * producers, seconds);
+        }
+    }
+}
+
+void bench_mpsc_last_published() {
+    constexpr uint64_t messages_per_producer = 2'000'000;
+    for (int producers : { 1, 2, 4 }) {
+        for (bool track : { true, false }) {
+            SlickQueue<Message> queue(1u << 16, queue_options{ .track_last_published = track });
+            double seconds = run_mpmc(queue, producers, 1, messages_per_producer);
+            print_result("mpsc_last_published",
+                std::string(track ? "tracked " : "untracked ") + std::to_string(producers) + "P/1C",
+                messages_per_producer * producers, seconds);
+        }
+    }
+}
+
+void bench_spsc_producer_policy() {
+    constexpr uint64_t messages = 5'000'000;
+    {
+        SlickQueue<Message> queue(1u << 16);
+        print_result("spsc_producer_policy", "multi_producer", messages, run_mpmc(queue, 1, 1, messages));
+    }
+    {
+        SlickQueue<Message, single_producer> queue(1u << 16);
+        print_result("spsc_producer_policy", "single_producer", messages, run_mpmc(queue, 1, 1, messages));
+    }
+}
+
+// One thread writes 16 entries, then reads them back, on a 1024-entry ring that stays in
+// L1. Measures the indexing work of reserve(), publish(), read() and operator[].
+template<typename Queue>
+double run_indexing(Queue& queue, uint64_t messages) {
+    constexpr uint32_t burst = 16;
+    uint64_t cursor = 0;
+    uint64_t checksum = 0;
+    auto start = clock_type::now();
+    for (uint64_t i = 0; i < messages; i += burst) {
+        for (uint32_t k = 0; k < burst; ++k) {
+            auto index = queue.reserve();
+            *queue[index] = index;
+            queue.publish(index);
+        }
+        for (uint32_t k = 0; k < burst; ++k) {
+            checksum += *queue.read(cursor).first;
+        }
+    }
+    double seconds = seconds_since(start);
+    if (checksum == 1) {
+        std::printf("unreachable\n");
+    }
+    return seconds;
+}
+
+void bench_static_capacity() {
+    constexpr uint64_t messages = 50'000'000;
+    {
+        SlickQueue<uint64_t, single_producer> queue(1024);
+        print_result("static_capacity", "runtime size", messages, run_indexing(queue, messages));
+    }
+    {
+        SlickQueue<uint64_t, single_producer, static_capacity<1024>> queue;
+        print_result("static_capacity", "static_capacity<1024>", messages, run_indexing(queue, messages));
+    }
+}
+
+void bench_mpsc_producer_block() {
+    constexpr uint64_t messages_per_producer = 1'000'000;
+    for (int producers : { 1, 2, 4, 8 }) {
+        for (uint32_t block : { 0u, 64u }) {
+            SlickQueue<Message> queue(1u << 16);
+            double seconds = run_mpmc(queue, producers, 1, messages_per_producer, block);
+            print_result("mpsc_producer_block",
+                std::string(block ? "make_producer(64) " : "reserve() ") + std::to_string(producers) + "P/1C",
+                messages_per_producer * producers, seconds);
+        }
+    }
+}
+
+// Producers reserve bursts of 16 slots, then publish every entry individually or the whole
+// burst with publish_range().
+void bench_burst_publish() {
+    constexpr uint64_t messages_per_producer = 2'000'000;
+    constexpr uint32_t burst = 16;
+    for (int producers : { 1, 4 }) {
+        for (bool range : { false, true }) {
+            SlickQueue<Message> queue(1u << 16);
+            double seconds = run_mpmc_with(queue, producers, 1, messages_per_producer, [&](SlickQueue<Message>& q) {
+                for (uint64_t i = 0; i < messages_per_producer; i += burst) {
+                    auto first = q.reserve(burst);
+                    for (uint32_t k = 0; k < burst; ++k) {
+                        q[first + k]->sequence = first + k;
+                    }
+                    if (range) {
+                        q.publish_range(first, burst);
+                    } else {
+                        for (uint32_t k = 0; k < burst; ++k) {
+                            q.publish(first + k);
+                        }
+                    }
+                }
+            });
+            print_result("burst_publish",
+                std::string(range ? "publish_range " : "publish x16 ") + std::to_string(producers) + "P/1C",
+                messages_per_producer * producers, seconds);
+        }
+    }
+}
+
+// Ping-pong over two queues. Returns the mean one-way latency in nanoseconds, which
+// includes the consumer polling the empty queue (yielding between polls) while waiting.
+double run_ping_pong(uint64_t round_trips) {
+    SlickQueue<Message> ping(1u << 10);
+    SlickQueue<Message> pong(1u << 10);
+    std::thread echo([&]() {
+        uint64_t cursor = 0;
+        for (uint64_t i = 0; i < round_trips; ++i) {
+            std::pair<Message*, uint32_t> read;
+            while (!(read = ping.read(cursor)).first) {
+                std::this_thread::yield();
+            }
+            auto index = pong.reserve();
+            *pong[index] = *read.first;
+            pong.publish(index);
+        }
+    });
+
+    uint64_t cursor = 0;
+    auto start = clock_type::now();
+    for (uint64_t i = 0; i < round_trips; ++i) {
+        auto index = ping.reserve();
+        ping[index]->sequence = i;
+        ping.publish(index);
+        while (!pong.read(cursor).first) {
+            std::this_thread::yield();
+        }
+    }
+    double seconds = seconds_since(start);
+    echo.join();
+    return seconds / round_trips / 2 * 1e9;
+}
+
+// Mean cost of read() on an empty queue for a caught-up consumer, in nanoseconds
+double run_empty_polls(bool was_reset, uint64_t polls) {
+    SlickQueue<Message> queue(1u << 16);
+    if (was_reset) {
+        for (uint32_t i = 0; i < queue.size(); ++i) {
+            queue.publish(queue.reserve());
+        }
+        queue.reset();
+    }
+    uint64_t cursor = 0;
+    uint64_t found = 0;
+    auto start = clock_type::now();
+    for (uint64_t i = 0; i < polls; ++i) {
+        found += queue.read(cursor).first != nullptr;
+    }
+    double seconds = seconds_since(start);
+    if (found != 0) {
+        std::printf("unreachable\n");
+    }
+    return seconds * 1e9 / polls;
+}
+
+// Each configuration runs on a fresh queue and on one that was reset() after a lap of
+// traffic. Empty polls of a caught-up consumer must cost the same in both.
+void bench_reader_path() {
+    constexpr uint64_t messages_per_producer = 2'000'000;
+    for (auto [producers, consumers] : { std::pair{ 1, 1 }, std::pair{ 2, 2 }, std::pair{ 4, 4 } }) {
+        for (bool was_reset : { false, true }) {
+            SlickQueue<Message> queue(1u << 16);
+            if (was_reset) {
+                for (uint32_t i = 0; i < queue.size(); ++i) {
+                    queue.publish(queue.reserve());
+                }
+                queue.reset();
+            }
+            double seconds = run_mpmc(queue, producers, consumers, messages_per_producer);
+            print_result("reader_path", std::to_string(producers) + "P/" + std::to_string(consumers) + "C" +
+                (was_reset ? " after reset()" : ""), messages_per_producer * producers, seconds);
+        }
+    }
+    for (bool was_reset : { false, true }) {
+        std::printf("%-24s %-40s %10.2f ns\n", "reader_path",
+            was_reset ? "empty read() after reset()" : "empty read()", run_empty_polls(was_reset, 20'000'000));
+    }
+    std::printf("%-24s %-40s %10.1f ns\n", "reader_path", "ping-pong one-way latency", run_ping_pong(100'000));
+}
+
+// One producer, workers share an atomic cursor. Returns items consumed per second.
+template<bool Batch>
+double run_work_queue(int workers, uint64_t messages) {
+    SlickQueue<Message> queue(1u << 16);
+    std::atomic<uint64_t> cursor{ 0 };
+    std::atomic<uint64_t> consumed{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> threads;
+
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&]() {
+            while (!go.load(std::memory_order_acquire)) {}
+            uint64_t local = 0;
+            while (cursor.load(std::memory_order_relaxed) < messages) {
+                if constexpr (Batch) {
+                    local += queue.read_batch(cursor).size();
+                } else {
+                    local += queue.read(cursor).first ? 1 : 0;
+                }
+            }
+            consumed.fetch_add(local);
+        });
+    }
+    threads.emplace_back([&]() {
+        while (!go.load(std::memory_order_acquire)) {}
+        for (uint64_t i = 0; i < messages; ++i) {
+            auto index = queue.reserve();
+            queue[index]->sequence = index;
+            queue.publish(index);
+        }
+    });
+
+    auto start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    return consumed.load() / seconds_since(start);
+}
+
+void bench_work_queue_claim() {
+    constexpr uint64_t messages = 4'000'000;
+    for (int workers : { 1, 2, 4, 8 }) {
+        auto suffix = " " + std::to_string(workers) + " workers";
+        std::printf("%-24s %-40s %10.2f Mmsg/s\n", "work_queue_claim", ("read" + suffix).c_str(),
+            run_work_queue<false>(workers, messages) / 1e6);
+        std::printf("%-24s %-40s %10.2f Mmsg/s\n", "work_queue_claim", ("read_batch" + suffix).c_str(),
+            run_work_queue<true>(workers, messages) / 1e6);
+    }
+}
+
+// Variable-length messages of 24 to 280 bytes, one producer and one consumer. The byte
+// ring frames each message in 32-byte chunks; the uint8_t queue spends a slot per byte.
+template<typename Push, typename Read>
+double run_byte_stream(uint64_t messages, Push push, Read read) {
+    std::atomic<bool> producing{ true };
+    std::thread consumer([&]() {
+        uint64_t cursor = 0;
+        uint64_t received = 0;
+        uint64_t bytes = 0;
+        while (received < messages) {
+            bool done = !producing.load(std::memory_order_acquire);
+            auto length = read(cursor);
+            if (length) {
+                bytes += length;
+                ++received;
+            } else if (done) {
+                break;
+            }
+        }
+        if (bytes == 1) {
+            std::printf("unreachable\n");
+        }
+    });
+    std::byte payload[280] = {};
+    auto start = clock_type::now();
+    for (uint64_t i = 0; i < messages; ++i) {
+        push(std::span<const std::byte>(payload, 24 + (i * 37) % 257));
+    }
+    producing.store(false, std::memory_order_release);
+    consumer.join();
+    return seconds_since(start);
+}
+
+void bench_byte_messages() {
+    constexpr uint64_t messages = 2'000'000;
+    {
+        SlickQueue<uint8_t> queue(1u << 20);
+        double seconds = run_byte_stream(messages, [&](std::span<const std::byte> message) {
+            auto n = static_cast<uint32_t>(message.size());
+            auto index = queue.reserve(n);
+            std::memcpy(queue[index], message.data(), n);
+            queue.publish(index, n);
+        }, [&](uint64_t& cursor) {
+            return queue.read(cursor).second;
+        });
+        print_result("byte_messages", "SlickQueue<uint8_t> reserve(n)", messages, seconds);
+    }
+    for (bool mirrored : { false, true }) {
+#if !defined(__linux__)
+        if (mirrored) {
+            continue;
+        }
+#endif
+        SlickByteQueue<> queue(1u << 20, queue_options{ .mirrored = mirrored });
+        double seconds = run_byte_stream(messages, [&](std::span<const std::byte> message) {
+            queue.push(message);
+        }, [&](uint64_t& cursor) {
+            return static_cast<uint32_t>(queue.read(cursor).size());
+        });
+        print_result("byte_messages", mirrored ? "SlickByteQueue mirrored" : "SlickByteQueue", messages, seconds);
+    }
+}
+
+// Elements of 256 bytes to 4 KB in a 256 MB ring, larger than the last level cache. One
+// single_producer thread fills the ring, then the consumer drains it with poll() and reads
+// every byte, so both sides run into cold lines. Compares queue_options::prefetch_distance.
+template<std::size_t Size>
+void run_large_elements() {
+    struct Element {
+        uint64_t words[Size / sizeof(uint64_t)];
+    };
+    constexpr uint32_t entries = (256u << 20) / Size;
+    constexpr int passes = 3;
+    for (uint32_t distance : { 0u, 2u, 8u }) {
+        SlickQueue<Element, single_producer> queue(entries, queue_options{ .prefetch_distance = distance });
+        uint64_t cursor = 0;
+        uint64_t checksum = 0;
+        double produce = 0;
+        double consume = 0;
+        for (int pass = 0; pass < passes; ++pass) {
+            auto start = clock_type::now();
+            for (uint32_t i = 0; i < entries; ++i) {
+                auto index = queue.reserve();
+                auto* element = queue[index];
+                for (auto& word : element->words) {
+                    word = index;
+                }
+                queue.publish(index);
+            }
+            produce += seconds_since(start);
+            start = clock_type::now();
+            while (queue.poll(cursor, [&](Element* element, uint32_t) {
+                for (auto word : element->words) {
+                    checksum += word;
+                }
+            }) != 0) {}
+            consume += seconds_since(start);
+        }
+        if (checksum == 1) {
+            std::printf("unreachable\n");
+        }
+        auto config = std::to_string(Size) + "B prefetch " + std::to_string(distance);
+        print_result("large_elements", config + " reserve", uint64_t(entries) * passes, produce);
+        print_result("large_elements", config + " poll", uint64_t(entries) * passes, consume);
+    }
+}
+
+void bench_large_elements() {
+    run_large_elements<256>();
+    run_large_elements<1024>();
+    run_large_elements<4096>();
+}
+
+#if defined(__linux__)
+// Consumer sleeps in epoll_wait on the notifier; the producer publishes its clock and the
+// consumer measures publish-to-read latency after every wake-up.
+void bench_notifier_wakeup() {
+    constexpr int rounds = 2000;
+    for (bool shm : { false, true }) {
+        SlickQueue<Message> producer(1u << 10, shm ? "slick_queue_bench_notifier" : nullptr);
+        std::optional<SlickQueue<Message>> attached;
+        if (shm) {
+            attached.emplace("slick_queue_bench_notifier");
+        }
+        auto& consumer = shm ? *attached : producer;
+
+        int epfd = ::epoll_create1(0);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ::epoll_ctl(epfd, EPOLL_CTL_ADD, consumer.notifier(), &ev);
+
+        std::atomic<int> waiting{ -1 };  // round the consumer is asleep in
+        double total_ns = 0;
+        std::thread reader([&]() {
+            uint64_t cursor = 0;
+            for (int i = 0; i < rounds; ++i) {
+                while (consumer.arm_notifier(cursor)) {
+                    waiting.store(i);
+                    epoll_event out;
+                    ::epoll_wait(epfd, &out, 1, 1000);
+                    consumer.drain_notifier();
+                }
+                auto [msg, n] = consumer.read(cursor);
+                if (msg) {
+                    auto now = clock_type::now().time_since_epoch().count();
+                    total_ns += std::chrono::duration<double, std::nano>(
+                        clock_type::duration(now - static_cast<int64_t>(msg->payload[0]))).count();
+                }
+            }
+        });
+        for (int i = 0; i < rounds; ++i) {
+            while (waiting.load() != i) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            auto index = producer.reserve();
+            producer[index]->payload[0] = static_cast<uint64_t>(clock_type::now().time_since_epoch().count());
+            producer.publish(index);
+        }
+        reader.join();
+        ::close(epfd);
+        std::printf("%-24s %-40s %10.1f us\n", "notifier_wakeup", shm ? "shm (unix socket)" : "local (eventfd)",
+            total_ns / rounds / 1e3);
+    }
+}
+#endif
+
+const struct {
+    const char* name;
+    void (*run)();
+} scenarios[] = {
+    { "mpmc_slot_mapping", bench_mpmc_slot_mapping },
+    { "mpsc_last_published", bench_mpsc_last_published },
+    { "spsc_producer_policy", bench_spsc_producer_policy },
+    { "static_capacity", bench_static_capacity },
+    { "work_queue_claim", bench_work_queue_claim },
+    { "reader_path", bench_reader_path },
+    { "mpsc_producer_block", bench_mpsc_producer_block },
+    { "burst_publish", bench_burst_publish },
+    { "byte_messages", bench_byte_messages },
+    { "large_elements", bench_large_elements },
+#if defined(__linux__)
+    { "notifier_wakeup", bench_notifier_wakeup },
+#endif
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    for (auto& scenario : scenarios) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || std::strcmp(argv[i], scenario.name) == 0;
+        }
+        if (selected) {
+            scenario.run();
+        }
+    }
+    return 0;
+}
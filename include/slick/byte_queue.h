@@ -0,0 +1,266 @@
+/********************************************************************************
+ * Copyright (c) 2020-2026 Slick Quant LLC
+ * All rights reserved
+ *
+ * This file is part of the SlickQueue. Redistribution and use in source and
+ * binary forms, with or without modification, are permitted exclusively under
+ * the terms of the MIT license which is available at
+ * https://github.com/SlickQuant/slick-queue/blob/main/LICENSE
+ *
+ ********************************************************************************/
+
+#pragma once
+
+#include <slick/queue.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace slick {
+
+/**
+ * @brief Writable payload of a message claimed with SlickByteQueue::claim()
+ */
+struct byte_claim {
+    uint64_t index = 0;             // sequence of the first chunk, pass back to commit()
+    std::span<std::byte> data;      // payload of the requested length
+};
+
+/**
+ * @brief Ring of variable-length byte messages built on SlickQueue::reserve(n)
+ *
+ * The ring is a SlickQueue of Chunk-byte chunks. A message takes as many consecutive chunks
+ * as its payload plus an 8-byte frame header holding the length, and costs a single
+ * reservation and a single control slot write however long it is. Reading cursors are
+ * chunk sequences and behave exactly like SlickQueue cursors, including loss detection,
+ * reset and the shared atomic cursor used for work queues.
+ *
+ * The control array still holds one slot per chunk, of which only the first of a message is
+ * used: 16 bytes per chunk, i.e. 25% on top of the payload with the default 64-byte chunks
+ * and 50% with 32-byte ones. Forwarding the compact_slots policy halves that, at the price of
+ * messages of at most 65535 chunks; larger chunks trade it against rounding waste.
+ *
+ * Messages never straddle the end of the ring, up to the chunks of the largest message are
+ * left unused at the wrap; with queue_options::mirrored those chunks are used as well.
+ *
+ * @tparam Chunk Allocation unit in bytes, a power of 2 >= 16
+ * @tparam Policies Optional policy tags forwarded to SlickQueue
+ */
+template<std::size_t Chunk = 64, typename... Policies>
+class SlickByteQueue {
+    static_assert(Chunk >= 16 && (Chunk & (Chunk - 1)) == 0, "Chunk must be a power of 2 >= 16");
+
+public:
+    struct alignas(16) chunk {
+        std::byte bytes[Chunk];
+    };
+
+    // Inline frame header at the start of the first chunk of every message
+    struct frame_header {
+        uint32_t length;
+        uint32_t reserved;
+    };
+    static constexpr std::size_t header_size = sizeof(frame_header);
+
+    using queue_type = SlickQueue<chunk, Policies...>;
+
+    /**
+     * @brief Construct a new SlickByteQueue object
+     *
+     * @param capacity Capacity of the ring in bytes, a power of 2 and a multiple of Chunk.
+     * @param shm_name The name of the shared memory segment. If nullptr, the queue will use local memory.
+     * @param options Creation options, see queue_options.
+     *
+     * @throws std::runtime_error if shared memory allocation fails.
+     * @throws std::invalid_argument if capacity is not a power of 2 multiple of Chunk.
+     */
+    SlickByteQueue(uint32_t capacity, const char* const shm_name = nullptr, const queue_options& options = {})
+        : queue_(chunks_for_capacity(capacity), shm_name, options)
+    {}
+
+    /**
+     * @brief Construct a new local memory SlickByteQueue object with creation options
+     */
+    SlickByteQueue(uint32_t capacity, const queue_options& options)
+        : SlickByteQueue(capacity, nullptr, options)
+    {}
+
+    /**
+     * @brief Open an existing SlickByteQueue in shared memory
+     *
+     * @param warm_up Prefault and lock the segment in this process, see warm_up_options.
+     *
+     * @throws std::runtime_error if the segment does not exist or was created with another Chunk size.
+     */
+    SlickByteQueue(const char* const shm_name, const warm_up_options& warm_up = {})
+        : queue_(shm_name, warm_up)
+    {}
+
+    /**
+     * @brief Get the capacity of the ring
+     * @return Capacity in bytes
+     */
+    uint64_t capacity() const noexcept { return static_cast<uint64_t>(queue_.size()) * Chunk; }
+
+    /**
+     * @brief Get the largest payload a single message can carry
+     * @return Maximum message length in bytes
+     */
+    uint32_t max_message_size() const noexcept {
+        return static_cast<uint32_t>(capacity() - header_size);
+    }
+
+    /**
+     * @brief Access the underlying chunk queue for waiting, notifiers and consumer registration
+     */
+    queue_type& queue() noexcept { return queue_; }
+    const queue_type& queue() const noexcept { return queue_; }
+
+    /**
+     * @brief Get the initial reading index, the sequence a new consumer should start from
+     */
+    uint64_t initial_reading_index() const noexcept { return queue_.initial_reading_index(); }
+
+    /**
+     * @brief Reserve space for a message of the given length
+     * @param length Payload length in bytes, 1 to max_message_size()
+     * @return Claim whose data is written in place and handed to commit()
+     *
+     * @throws std::invalid_argument if length is 0
+     * @throws std::runtime_error if length exceeds max_message_size()
+     */
+    byte_claim claim(uint32_t length) {
+        auto n = chunks_for(length);
+        auto index = queue_.reserve(n);
+        return frame(index, length);
+    }
+
+    /**
+     * @brief Reserve space for a message without waiting on backpressure
+     * @return Claim, or std::nullopt if a registered consumer has not freed enough chunks yet
+     */
+    std::optional<byte_claim> try_claim(uint32_t length) {
+        auto index = queue_.try_reserve(chunks_for(length));
+        if (!index) {
+            return std::nullopt;
+        }
+        return frame(*index, length);
+    }
+
+    /**
+     * @brief Publish a claimed message to consumers
+     */
+    void commit(const byte_claim& claim) noexcept {
+        queue_.publish(claim.index, chunk_count(static_cast<uint32_t>(claim.data.size())));
+    }
+
+    /**
+     * @brief Copy a message into the ring and publish it
+     * @return Sequence of the message
+     */
+    uint64_t push(std::span<const std::byte> message) {
+        auto claimed = claim(static_cast<uint32_t>(message.size()));
+        std::memcpy(claimed.data.data(), message.data(), message.size());
+        commit(claimed);
+        return claimed.index;
+    }
+
+    /**
+     * @brief Read the next message
+     * @param read_index Reference to the reading index, will be updated past the message
+     * @return Payload of the message, empty if no data is available
+     *
+     * The span stays valid until producers lap the reader, as with SlickQueue::read().
+     */
+    std::span<const std::byte> read(uint64_t& read_index) noexcept {
+        auto [data, n] = queue_.read(read_index);
+        return payload(data, n);
+    }
+
+    /**
+     * @brief Read the next message from a cursor shared by several consumers
+     * @param read_index Shared reading index, every message is handed to one consumer only
+     */
+    std::span<const std::byte> read(std::atomic<uint64_t>& read_index) noexcept {
+        auto [data, n] = queue_.read(read_index);
+        return payload(data, n);
+    }
+
+    /**
+     * @brief Wait for and read the next message
+     * @param timeout Longest time to wait, see SlickQueue::read_wait()
+     */
+    template<typename Wait = relax_wait, typename Rep, typename Period>
+    std::span<const std::byte> read_wait(uint64_t& read_index, std::chrono::duration<Rep, Period> timeout) noexcept {
+        auto [data, n] = queue_.template read_wait<Wait>(read_index, timeout);
+        return payload(data, n);
+    }
+
+    /**
+     * @brief Read the last published message
+     * @return Payload of the message, empty if nothing was published
+     */
+    std::span<const std::byte> read_last() noexcept {
+        auto [data, n] = queue_.read_last();
+        return payload(data, n);
+    }
+
+    /**
+     * @brief Get count of chunks skipped because they were overwritten, see SlickQueue::loss_count()
+     * @return Number of chunks skipped
+     */
+    uint64_t loss_count() const noexcept { return queue_.loss_count(); }
+
+    /**
+     * @brief Reset the ring, invalidating all existing messages
+     */
+    void reset() noexcept { queue_.reset(); }
+
+    bool use_shm() const noexcept { return queue_.use_shm(); }
+    bool mirrored() const noexcept { return queue_.mirrored(); }
+
+private:
+    static uint32_t chunks_for_capacity(uint32_t capacity) {
+        if (capacity < Chunk || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("capacity must be a power of 2 and at least " + std::to_string(Chunk) + " bytes");
+        }
+        return static_cast<uint32_t>(capacity / Chunk);
+    }
+
+    static constexpr uint32_t chunk_count(uint32_t length) noexcept {
+        return static_cast<uint32_t>((header_size + length + Chunk - 1) / Chunk);
+    }
+
+    uint32_t chunks_for(uint32_t length) const {
+        if (length == 0) [[unlikely]] {
+            throw std::invalid_argument("message length must be > 0");
+        }
+        if (length > max_message_size()) [[unlikely]] {
+            throw std::runtime_error("message length " + std::to_string(length) + " > max message size " +
+                std::to_string(max_message_size()));
+        }
+        return chunk_count(length);
+    }
+
+    byte_claim frame(uint64_t index, uint32_t length) noexcept {
+        auto* first = queue_[index]->bytes;
+        auto* header = reinterpret_cast<frame_header*>(first);
+        header->length = length;
+        header->reserved = 0;
+        return byte_claim{ index, std::span<std::byte>(first + header_size, length) };
+    }
+
+    static std::span<const std::byte> payload(const chunk* data, uint32_t n) noexcept {
+        if (!data) {
+            return {};
+        }
+        auto* header = reinterpret_cast<const frame_header*>(data->bytes);
+        // a lapped reader can see a header of a newer message, never run past the entry
+        auto length = std::min<std::size_t>(header->length, static_cast<std::size_t>(n) * Chunk - header_size);
+        return std::span<const std::byte>(data->bytes + header_size, length);
+    }
+
+    queue_type queue_;
+};
+
+}
@@ -21,6 +21,10 @@
 
 #include <slick/shm/shared_memory.hpp>
 
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
 // Undef Windows min/max macros that slick-shm may have pulled in
 #if defined(_WIN32) || defined(_MSC_VER)
 #ifdef max
@@ -33,17 +37,45 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <atomic>
 #include <stdexcept>
 #include <string>
 #include <cassert>
 #include <thread>
 #include <chrono>
+#include <coroutine>
 #include <limits>
+#include <memory_resource>
 #include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
 
 #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
 #include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <linux/membarrier.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/vfs.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #endif
 
 #ifndef SLICK_QUEUE_ENABLE_LOSS_DETECTION
@@ -58,48 +90,429 @@
 #define SLICK_QUEUE_ENABLE_CPU_RELAX 1
 #endif
 
+// Directory of the hugetlbfs mount holding shared memory queues created with
+// queue_options::huge_pages
+#ifndef SLICK_QUEUE_HUGETLBFS_DIR
+#define SLICK_QUEUE_HUGETLBFS_DIR "/dev/hugepages"
+#endif
+
 namespace slick {
 
+/**
+ * @brief Memory layout of the control and data arrays.
+ *
+ * - separate:    control slots and elements live in two parallel arrays (default).
+ * - interleaved: each entry is a cache-line aligned {sequence, size, T} record, so a
+ *                consumer touches a single cache line per message. Multi-slot
+ *                reservations are not supported in this layout since consecutive
+ *                elements are not contiguous.
+ * - packed:      the element is stored in its control slot in place of the size, and there
+ *                is no data array. Selected by the value_in_slot policy, not by options.
+ *                Single-slot reservations only, like interleaved.
+ */
+enum class queue_layout : uint32_t {
+    separate = 0,
+    interleaved = 1,
+    packed = 2,
+};
+
+/**
+ * @brief Mapping from sequence index to control slot in the separate layout.
+ *
+ * - linear:   slot i holds sequence i; four consecutive sequences share a cache line, eight
+ *             with the compact_slots policy (default).
+ * - padded:   every slot is padded to a full cache line.
+ * - swizzled: the low bits of the index are rotated to the top so that consecutive
+ *             sequences land on different cache lines without growing the control array.
+ *             Consumers lose spatial locality on the control array in exchange.
+ *
+ * Only slot_mapping::linear is valid with queue_layout::interleaved, where every record
+ * already owns its cache line. queue_layout::packed supports all three.
+ */
+enum class slot_mapping : uint32_t {
+    linear = 0,
+    padded = 1,
+    swizzled = 2,
+};
+
+/**
+ * @brief Pages backing the control and data arrays, see queue_options::huge_pages.
+ *
+ * - base:             regular pages.
+ * - transparent_huge: regular mapping advised with MADV_HUGEPAGE; the kernel promotes it to
+ *                     huge pages when it can, page_size() still reports the base page size.
+ * - huge:             hugetlb pages (MAP_HUGETLB, MFD_HUGETLB or a hugetlbfs file).
+ */
+enum class page_backing : uint32_t {
+    base = 0,
+    transparent_huge = 1,
+    huge = 2,
+};
+
+/**
+ * @brief NUMA memory policy for the queue memory, see queue_options::numa.
+ *
+ * - none:       pages land on the node that touches them first (default).
+ * - preferred:  pages are allocated on queue_options::numa_node while it has free memory.
+ * - bind:       pages are allocated on queue_options::numa_node only.
+ * - interleave: pages are spread round robin over all nodes with memory, for broadcast rings
+ *               read from every socket.
+ */
+enum class numa_policy : uint32_t {
+    none = 0,
+    preferred = 1,
+    bind = 2,
+    interleave = 3,
+};
+
+/**
+ * @brief Warm-up of the queue memory when a queue is created or attached.
+ *
+ * Page faults on the first lap through a fresh mapping show up as latency spikes right
+ * after startup. Warm-up moves them into the constructor; warm_up_time() reports its cost.
+ */
+struct warm_up_options {
+    // Fault in every page of the arrays (and of the whole segment for shared memory),
+    // including the second view of a mirrored ring
+    bool prefault = false;
+    // mlock() the memory so it is never paged out, see SlickQueue::locked()
+    bool lock = false;
+    // Threads sharing the prefault, the kernel zeroes fresh pages in parallel
+    uint32_t threads = 1;
+};
+
+/**
+ * @brief Creation options for SlickQueue.
+ *
+ * Options that change the memory layout are recorded in the shared memory header so
+ * attaching processes pick them up automatically.
+ */
+struct queue_options {
+    queue_layout layout = queue_layout::separate;
+    slot_mapping mapping = slot_mapping::linear;
+    // Maintain the last published index on every publish() so read_last() is O(1).
+    // When false, publish() skips the contended CAS and read_last() scans the control
+    // array backwards from the reservation cursor instead.
+    bool track_last_published = true;
+    // Non-lossy mode: reserve() waits and try_reserve() refuses when the claim would
+    // overwrite a slot that a registered consumer has not committed yet.
+    bool backpressure = false;
+    // Number of consumer cursors that can be registered in backpressure mode
+    uint32_t max_consumers = 16;
+    // Map the data array twice back to back in virtual memory so that every reservation
+    // of up to size() slots is contiguous and never skips to the start of the ring.
+    // Linux only, requires queue_layout::separate and a data array of whole pages.
+    bool mirrored = false;
+    // Back the arrays with huge pages to cut dTLB misses on large rings. Local queues use
+    // MAP_HUGETLB, shared memory queues a file in SLICK_QUEUE_HUGETLBFS_DIR that attachers
+    // open by name. Falls back to transparent huge pages and then to base pages; backing()
+    // and page_size() report what was obtained. Linux only, ignored elsewhere.
+    bool huge_pages = false;
+    // Place the arrays, and for shared memory the whole segment including the header, with
+    // mbind() before they are first touched. Linux only, ignored elsewhere.
+    numa_policy numa = numa_policy::none;
+    // Target node of numa_policy::preferred and numa_policy::bind
+    uint32_t numa_node = 0;
+    // Prefault and lock the memory of this instance at construction
+    warm_up_options warm_up = {};
+    // Leave the data array uninitialized instead of default-constructing size() elements.
+    // Producers construct each element with emplace(), which destroys the object a previous
+    // lap left at the same position. T does not need a default constructor in this mode.
+    bool uninitialized = false;
+    // Allocate a local queue from this resource instead of the global heap, as one block
+    // holding the consumer cursors and the arrays. Ignored by shared memory queues; cannot
+    // be combined with mirrored, huge_pages or numa, which map their own memory.
+    std::pmr::memory_resource* memory_resource = nullptr;
+    // Software prefetch distance in slots, 0 disables it. poll() and read_batch() prefetch
+    // the control slot and element this many slots ahead of each entry they return, and
+    // single_producer reservations and producer handles prefetch the slot ahead for writing.
+    // Per instance, see SlickQueue::set_prefetch_distance().
+    uint32_t prefetch_distance = 0;
+};
+
+/**
+ * @brief Producer policy: any number of threads/processes may call reserve() and publish() (default).
+ */
+struct multi_producer {};
+
+/**
+ * @brief Producer policy: exactly one SlickQueue instance calls reserve() and publish().
+ *
+ * Reservations come from a cursor cached in the producing instance and are announced with
+ * plain release stores instead of atomic read-modify-writes. The shared memory layout and
+ * the read() protocol are unchanged, so regular SlickQueue<T> consumers can attach to it.
+ */
+struct single_producer {};
+
+/**
+ * @brief Storage policy for small trivially copyable T: keep each element in its control slot.
+ *
+ * The element takes the place of the size field, so the queue is a single array of 16-byte
+ * slots (queue_layout::packed) instead of a control array plus a data array. A producer
+ * writes the value and release-stores the sequence into the same cache line; a consumer
+ * acquires the sequence and finds the value next to it without touching a second array.
+ * Requires sizeof(T) <= 8 and alignof(T) <= 8; reservations are single-slot only.
+ */
+struct value_in_slot {};
+
+/**
+ * @brief Storage policy: encode every control slot as one 8-byte word.
+ *
+ * The word packs a 48-bit sequence and a 16-bit size, like the reservation cursor, instead
+ * of a 16-byte {sequence, size} pair, which halves the control array. The encoding is a
+ * property of the type so that queues without it keep a branch-free slot access path.
+ * Requires queue_layout::separate and reserve(n) with n <= 65535; recorded in the shared
+ * memory header, and only queues with the policy attach to such segments.
+ */
+struct compact_slots {};
+
+/**
+ * @brief Capacity policy: fix the queue size at compile time.
+ *
+ * size() and the index mask become constants, so the masking in operator[], read() and
+ * reserve() is folded into the generated code instead of loaded from the instance; with the
+ * default separate layout and linear mapping an element address is `and $N-1; lea`. The
+ * shared memory layout is the same as for a runtime-sized queue of N elements, and either
+ * kind can attach to a segment created by the other.
+ *
+ * @tparam N Capacity, a power of 2
+ */
+template<uint32_t N>
+struct static_capacity {
+    static_assert(N != 0 && (N & (N - 1)) == 0, "static_capacity must be a power of 2");
+    static constexpr uint32_t value = N;
+};
+
+template<typename Policy>
+struct is_queue_policy : std::false_type {};
+template<> struct is_queue_policy<multi_producer> : std::true_type {};
+template<> struct is_queue_policy<single_producer> : std::true_type {};
+template<> struct is_queue_policy<value_in_slot> : std::true_type {};
+template<> struct is_queue_policy<compact_slots> : std::true_type {};
+template<uint32_t N> struct is_queue_policy<static_capacity<N>> : std::true_type {};
+
+// Capacity given by a static_capacity policy, 0 for any other policy
+template<typename Policy>
+struct static_capacity_of : std::integral_constant<uint32_t, 0> {};
+template<uint32_t N>
+struct static_capacity_of<static_capacity<N>> : std::integral_constant<uint32_t, N> {};
+
+inline void cpu_relax() noexcept {
+#if SLICK_QUEUE_ENABLE_CPU_RELAX
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+#else
+    (void)0;
+#endif
+}
+
+// Software prefetch of the cache line holding address, into all cache levels
+inline void prefetch_read(const void* address) noexcept {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+}
+
+// Prefetch with intent to write (PREFETCHW where the target supports it)
+inline void prefetch_write(const void* address) noexcept {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _m_prefetchw(address);
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 1, 3);
+#else
+    (void)address;
+#endif
+}
+
+/**
+ * @brief Wait strategies for SlickQueue::read_wait() and SlickQueue::wait_for().
+ *
+ * A strategy is a type with a static idle(uint32_t spins) called after every empty poll,
+ * where spins counts the empty polls of the current wait. Any such type can be passed.
+ *
+ * - busy_spin_wait: poll again immediately; lowest latency, burns a core.
+ * - relax_wait:     cpu_relax() between polls (default).
+ * - yield_wait:     std::this_thread::yield() between polls.
+ * - sleep_wait:     sleep for sleep_wait::interval between polls.
+ * - blocking_wait:  spin for blocking_wait::spin_limit polls, then sleep on a futex word that
+ *                   producers signal, across processes for shared memory queues. Producers
+ *                   only pay the wake-up syscall while a consumer is asleep and no fence at
+ *                   all, the consumer issues membarrier() before it sleeps. Falls back to
+ *                   sleep_wait where futexes are not available (non-Linux, v1 segments).
+ */
+struct busy_spin_wait {
+    static void idle(uint32_t) noexcept {}
+};
+
+struct relax_wait {
+    static void idle(uint32_t) noexcept { cpu_relax(); }
+};
+
+struct yield_wait {
+    static void idle(uint32_t) noexcept { std::this_thread::yield(); }
+};
+
+struct sleep_wait {
+    static constexpr std::chrono::microseconds interval{ 50 };
+    static void idle(uint32_t) noexcept { std::this_thread::sleep_for(interval); }
+};
+
+struct blocking_wait {
+    static constexpr uint32_t spin_limit = 256;
+    static void idle(uint32_t) noexcept { cpu_relax(); }
+};
+
 /**
  * @brief A lock-free multi-producer multi-consumer queue with optional shared memory support.
  * 
  * This queue allows a multiple producer thread to write data and a multiple consumer thread to read data concurrently without locks.
  * It can optionally use shared memory for inter-process communication.
- * This queue is lossy: if producers outrun consumers, older data may be overwritten.
+ * This queue is lossy: if producers outrun consumers, older data may be overwritten, unless
+ * it is created with queue_options::backpressure and consumers register gating cursors.
  * 
  * @tparam T The type of elements stored in the queue.
+ * @tparam Policies Optional policies, e.g. single_producer.
  */
-template<typename T>
+template<typename T, typename... Policies>
 class SlickQueue {
+    static_assert((is_queue_policy<Policies>::value && ...), "unknown SlickQueue policy");
+    static_assert(!((std::is_same_v<Policies, single_producer> || ...) && (std::is_same_v<Policies, multi_producer> || ...)),
+        "single_producer and multi_producer are mutually exclusive");
+
+    static constexpr bool single_producer_ = (std::is_same_v<Policies, single_producer> || ...);
+    static constexpr bool value_in_slot_ = (std::is_same_v<Policies, value_in_slot> || ...);
+    static constexpr bool compact_slots_ = (std::is_same_v<Policies, slick::compact_slots> || ...);
+    static_assert(!(value_in_slot_ && compact_slots_), "value_in_slot and compact_slots are mutually exclusive");
+    static_assert(((static_capacity_of<Policies>::value != 0) + ... + 0) <= 1, "static_capacity given more than once");
+    static constexpr uint32_t static_capacity_ = (static_capacity_of<Policies>::value + ... + 0u);
+    static_assert(!value_in_slot_ || (std::is_trivially_copyable_v<T> && sizeof(T) <= 8 && alignof(T) <= 8),
+        "value_in_slot requires a trivially copyable T of at most 8 bytes");
     static constexpr uint64_t kInvalidIndex = std::numeric_limits<uint64_t>::max();
+    static constexpr uint32_t kDefaultClaimBatch = 64;
 
     struct slot {
         std::atomic_uint_fast64_t data_index{ kInvalidIndex };
         uint32_t size = 1;
     };
 
+    // Offset of the element in a slot of the packed layout, overlapping size
+    static constexpr std::size_t slot_value_offset = sizeof(std::atomic_uint_fast64_t);
+    static_assert(!value_in_slot_ || sizeof(slot) >= slot_value_offset + 8, "slot cannot hold the element");
+
+    // Control slot of the compact_slots policy, make_reserved_info(sequence, size) or kInvalidIndex
+    using compact_slot = std::atomic<uint64_t>;
+
     using reserved_info = uint64_t;
 
+    // Intrusive waiter list entry, embedded in the awaiter that lives in the coroutine frame
+    struct awaiter_node {
+        awaiter_node* next = nullptr;
+        std::coroutine_handle<> handle;
+        void (*schedule)(void* scheduler, std::coroutine_handle<> handle) = nullptr;
+        void* scheduler = nullptr;
+        uint64_t read_index = 0;
+    };
+
 #if defined(__cpp_lib_hardware_interference_size)
     static constexpr std::size_t cacheline_size = std::hardware_destructive_interference_size;
 #else
     static constexpr std::size_t cacheline_size = 64;
 #endif
 
+    static constexpr std::size_t align_up(std::size_t value, std::size_t alignment) noexcept {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Interleaved layout record: [slot][padding][T][padding up to the record alignment]
+    static constexpr std::size_t record_align = alignof(T) > cacheline_size ? alignof(T) : cacheline_size;
+    static constexpr std::size_t record_data_offset = align_up(sizeof(slot), alignof(T));
+    static constexpr std::size_t record_size = align_up(record_data_offset + sizeof(T), record_align);
+
     uint32_t size_;
     uint32_t mask_;
-    T* data_ = nullptr;
-    slot* control_ = nullptr;
+    queue_layout layout_ = queue_layout::separate;
+    uint8_t* data_ = nullptr;        // address of element 0
+    uint8_t* control_ = nullptr;     // address of slot 0
+    std::size_t control_stride_ = sizeof(slot);
+    slot_mapping mapping_ = slot_mapping::linear;
+    bool linear_slots_ = true;       // slot i at control_ + i * slot_bytes(), see slot_address()
+    uint32_t swizzle_mask_ = 0;      // low index bits moved to the top by slot_mapping::swizzled
+    uint32_t swizzle_bits_ = 0;
+    uint32_t swizzle_shift_ = 0;
     std::atomic<reserved_info>* reserved_ = nullptr;
     std::atomic<uint64_t>* last_published_ = nullptr;
+    std::atomic<uint64_t>* reset_epoch_ = nullptr;
+    std::atomic<uint64_t>* reset_limit_ = nullptr;    // highest reservation index any reset() discarded
+    std::atomic<uint32_t>* wait_seq_ = nullptr;       // futex word, bumped when sleepers are woken
+    std::atomic<uint32_t>* sleepers_ = nullptr;       // consumers currently asleep in blocking_wait
+    std::atomic<uint32_t>* notify_armed_ = nullptr;   // consumer asked for a notifier signal
     alignas(cacheline_size) std::atomic<reserved_info> reserved_local_{0};
     alignas(cacheline_size) std::atomic<uint64_t> last_published_local_{kInvalidIndex};
+    alignas(cacheline_size) std::atomic<uint64_t> reset_epoch_local_{0};
+    std::atomic<uint64_t> reset_limit_local_{0};
+    // reservation index this instance last saw in reserved_ (upper 48 bits) and the low
+    // 16 bits of the reset epoch it was seen in, see was_reset()
+    mutable std::atomic<uint64_t> reset_seen_{0};
+    alignas(cacheline_size) std::atomic<uint32_t> wait_seq_local_{0};
+    std::atomic<uint32_t> sleepers_local_{0};
+    std::atomic<uint32_t> notify_armed_local_{0};
+    std::atomic<int> notify_fd_{-1};     // eventfd or bound socket of the notifier, consumer side
+    std::atomic<int> notify_send_fd_{-1}; // unbound socket producers signal a shm notifier through
+    // coroutines suspended in async_read(); those with a scheduler are handed to it by publish()
+    // on this instance, the others are resumed by resume_ready()
+    std::atomic_flag awaiters_lock_ = ATOMIC_FLAG_INIT;
+    std::atomic<uint32_t> awaiter_count_{0};  // linked awaiters with a scheduler
+    awaiter_node* awaiters_ = nullptr;
+    // waiters run heavy_fence(), so publish() gets away with a compiler barrier, see light_fence()
+    bool asymmetric_fence_ = asymmetric_fence_available();
 #if SLICK_QUEUE_ENABLE_LOSS_DETECTION
     alignas(cacheline_size) std::atomic<uint64_t> loss_count_{0};
 #endif
+    // single_producer state, only touched by the producing thread
+    alignas(cacheline_size) uint64_t producer_index_ = 0;
+    uint64_t producer_last_published_ = kInvalidIndex;
+    // backpressure: slowest consumer cursor seen by this instance's producers, refreshed
+    // only when a claim would run past it
+    std::atomic<uint64_t> gating_cache_{0};
+    std::atomic<uint32_t>* consumer_count_ = nullptr;  // registered gating cursors
+    std::atomic<uint32_t> consumer_count_local_{0};
+    bool backpressure_ = false;
+    uint32_t max_consumers_ = 0;
+    uint8_t* gating_ = nullptr;      // consumer cursors, GATING_STRIDE bytes apart
     bool own_ = false;
     bool use_shm_ = false;
     bool last_published_valid_ = false;
+    bool scan_last_published_ = false;
+    bool shared_wait_state_ = false;  // wait state is seen by every user of the queue
+    bool mirrored_ = false;           // data_ is followed by a second mapping of itself
+    bool uninitialized_ = false;      // elements are constructed by emplace() only
+    uint8_t* occupied_ = nullptr;     // per position: holds a live T, uninitialized mode with non-trivial ~T only
+    bool huge_pages_ = false;         // huge pages were requested at creation
+    page_backing backing_ = page_backing::base;
+    std::size_t backing_page_size_ = base_page_size();
+    uint8_t* mapped_ = nullptr;       // arrays or segment mapped by this instance rather than new/slick-shm
+    std::size_t mapped_bytes_ = 0;
+    std::string huge_path_;           // hugetlbfs file of the segment
+    numa_policy numa_ = numa_policy::none;
+    uint32_t numa_node_ = 0;
+    bool locked_ = false;
+    std::chrono::nanoseconds warm_up_time_{ 0 };
+    uint32_t prefetch_distance_ = 0;  // slots ahead, 0 when prefetching is off
+    std::pmr::memory_resource* resource_ = nullptr;  // source of block_, nullptr for a caller buffer
+    uint8_t* block_ = nullptr;        // local block: gating cursors, arrays and occupancy
+    std::size_t block_bytes_ = 0;
+    uint32_t header_size_ = HEADER_SIZE_V2;
     slick::shm::shared_memory shm_;  // RAII wrapper for shared memory
     void* lpvMem_ = nullptr;          // Cached data pointer
     std::string shm_name_;            // Stored for cleanup
@@ -108,27 +521,112 @@ class SlickQueue {
     //
     // The shared memory segment is organized as follows:
     //
-    // [HEADER: 64 bytes]
+    // [HEADER v2: 1024 bytes, header_magic 'SLQ2']
+    //   The header is split into 128-byte line pairs so that every hot atomic owns its
+    //   cache line and the adjacent-line prefetcher does not drag a neighbor in with it.
+    //
+    //   Line pair 0 (offset 0-127): read-mostly metadata
+    //     Offset 0-7   (8 bytes):  unused (reservation cursor in v1)
+    //     Offset 8-15  (8 bytes):  zero, the v1 size and element_size, so that v1 readers
+    //                              reject the segment instead of misreading it
+    //     Offset 16-23 (8 bytes):  unused (last published index in v1)
+    //     Offset 24-27 (4 bytes):  header_magic - layout/version marker
+    //     Offset 28-31 (4 bytes):  layout - queue_layout of the arrays below
+    //     Offset 32-35 (4 bytes):  mapping - slot_mapping of the control array
+    //     Offset 36-39 (4 bytes):  flags - HEADER_FLAG_* bits
+    //     Offset 40-43 (4 bytes):  max_consumers - gating cursor count (backpressure mode)
+    //     Offset 44-47 (4 bytes):  page_backing - pages the creator obtained for the segment
+    //     Offset 48-51 (4 bytes):  init_state - atomic init state (0=uninit,1=legacy,2=init,3=ready)
+    //     Offset 52-63:            PADDING
+    //     Offset 64-67 (4 bytes):  size_ - queue capacity (uint32_t)
+    //     Offset 68-71 (4 bytes):  element_size - sizeof(T) for validation (uint32_t)
+    //     Offset 72-127:           PADDING - reserved for future use
+    //   Line pair 1 (offset 128-255): std::atomic<reserved_info> - reservation cursor
+    //   Line pair 2 (offset 256-383): std::atomic<uint64_t> - last published index
+    //   Line pair 3 (offset 384-511): reset detection, written only by reset()
+    //     Offset 384-391 (8 bytes): std::atomic<uint64_t> - reset epoch, bumped by reset()
+    //     Offset 392-399 (8 bytes): std::atomic<uint64_t> - reset limit, highest discarded reservation index
+    //   Line pair 4 (offset 512-639): blocking_wait state, written only while consumers sleep
+    //     Offset 512-515 (4 bytes): std::atomic<uint32_t> - futex word
+    //     Offset 516-519 (4 bytes): std::atomic<uint32_t> - sleeping consumer count
+    //     Offset 520-523 (4 bytes): unused
+    //     Offset 524-527 (4 bytes): std::atomic<uint32_t> - notifier armed by its consumer
+    //   Line pair 5 (offset 640-767): backpressure state, written only on (un)registration
+    //     Offset 640-643 (4 bytes): std::atomic<uint32_t> - registered consumer count
+    //   Line pairs 6-7 (offset 768-1023): reserved for future hot atomics
+    //
+    // [GATING CURSORS: GATING_STRIDE * max_consumers, backpressure mode only]
+    //   One std::atomic<uint64_t> consumer cursor per 128-byte line pair,
+    //   kInvalidIndex when the entry is not registered
+    //
+    // [HEADER v1: 64 bytes, header_magic 'SLQ1' or none for legacy segments]
+    //   Still supported when attaching to segments created by older versions.
     //   Offset 0-7   (8 bytes):  std::atomic<reserved_info> - reservation cursor
     //   Offset 8-11  (4 bytes):  size_ - queue capacity (uint32_t)
     //   Offset 12-15 (4 bytes):  element_size - sizeof(T) for validation (uint32_t)
     //   Offset 16-23 (8 bytes):  std::atomic<uint64_t> - last published index
-    //   Offset 24-27 (4 bytes):  header_magic - layout/version marker
-    //   Offset 28-47 (20 bytes): PADDING - reserved for future use
-    //   Offset 48-51 (4 bytes):  init_state - atomic init state (0=uninit,1=legacy,2=init,3=ready)
-    //   Offset 52-63 (12 bytes): PADDING - reserved for future use
+    //   Offset 24-27 (4 bytes):  header_magic - 'SLQ1', or none for legacy segments
+    //   Offset 28-31:            unused, v1 segments are always separate and linear
+    //   Offset 32-47 (16 bytes): reset epoch and limit as in v2 line pair 3, written by v1.5
+    //                            and later only
+    //   Offset 48-51 (4 bytes):  init_state, as in v2
     //
-    // [CONTROL ARRAY: sizeof(slot) * size_]
-    //   Array of slot structures containing atomic indices and sizes
+    // [CONTROL ARRAY: sizeof(slot) * size_, or cacheline_size * size_ with slot_mapping::padded]
+    //   Array of slot structures containing atomic indices and sizes. With
+    //   HEADER_FLAG_COMPACT_SLOTS every slot is a single 8-byte word holding the sequence
+    //   in the upper 48 bits and the size in the lower 16 bits.
     //
     // [DATA ARRAY: sizeof(T) * size_]
-    //   Array of queue elements
+    //   Array of queue elements. With HEADER_FLAG_MIRRORED it starts at the next page
+    //   boundary and every process maps it twice back to back.
+    //
+    // [OCCUPANCY ARRAY: size_ bytes, HEADER_FLAG_UNINITIALIZED with non-trivially destructible T only]
+    //   Non-zero where a position holds a constructed element
+    //
+    // With queue_layout::interleaved the two arrays are replaced by a single array of
+    // cache-line aligned records:
+    //
+    // [RECORD ARRAY: record_size * size_]
+    //   Each record holds a slot at offset 0 followed by T at record_data_offset
+    //
+    // With queue_layout::packed there is no data array:
+    //
+    // [CONTROL ARRAY: as above]
+    //   Each slot holds T at offset 8 in place of the size, which is always 1
     //
     static constexpr uint32_t HEADER_SIZE = 64;
+    static constexpr uint32_t HEADER_SIZE_V2 = 1024;
+    static constexpr uint32_t HEADER_LINE_PAIR = 128;
+    static constexpr uint32_t SIZE_OFFSET = 8;
+    static constexpr uint32_t ELEMENT_SIZE_OFFSET = 12;
+    static constexpr uint32_t SIZE_OFFSET_V2 = 64;
+    static constexpr uint32_t ELEMENT_SIZE_OFFSET_V2 = 68;
     static constexpr uint32_t LAST_PUBLISHED_OFFSET = 16;
     static constexpr uint32_t HEADER_MAGIC_OFFSET = 24;
+    static constexpr uint32_t LAYOUT_OFFSET = 28;
+    static constexpr uint32_t SLOT_MAPPING_OFFSET = 32;
+    static constexpr uint32_t FLAGS_OFFSET = 36;
+    static constexpr uint32_t MAX_CONSUMERS_OFFSET = 40;
+    static constexpr uint32_t PAGE_BACKING_OFFSET = 44;
+    static constexpr uint32_t GATING_STRIDE = HEADER_LINE_PAIR;
     static constexpr uint32_t INIT_STATE_OFFSET = 48;  // Offset in header for atomic init state
+    static constexpr uint32_t RESERVED_OFFSET_V2 = HEADER_LINE_PAIR;
+    static constexpr uint32_t LAST_PUBLISHED_OFFSET_V2 = 2 * HEADER_LINE_PAIR;
+    static constexpr uint32_t RESET_EPOCH_OFFSET_V2 = 3 * HEADER_LINE_PAIR;
+    static constexpr uint32_t RESET_LIMIT_OFFSET_V2 = RESET_EPOCH_OFFSET_V2 + 8;
+    static constexpr uint32_t RESET_EPOCH_OFFSET_V1 = 32;
+    static constexpr uint32_t RESET_LIMIT_OFFSET_V1 = 40;
+    static constexpr uint32_t WAIT_SEQ_OFFSET_V2 = 4 * HEADER_LINE_PAIR;
+    static constexpr uint32_t SLEEPERS_OFFSET_V2 = WAIT_SEQ_OFFSET_V2 + 4;
+    static constexpr uint32_t NOTIFY_ARMED_OFFSET_V2 = WAIT_SEQ_OFFSET_V2 + 12;
+    static constexpr uint32_t CONSUMER_COUNT_OFFSET_V2 = 5 * HEADER_LINE_PAIR;
     static constexpr uint32_t HEADER_MAGIC = 0x534C5131; // 'SLQ1'
+    static constexpr uint32_t HEADER_MAGIC_V2 = 0x534C5132; // 'SLQ2'
+    static constexpr uint32_t HEADER_FLAG_UNTRACKED_LAST_PUBLISHED = 1u << 0;
+    static constexpr uint32_t HEADER_FLAG_BACKPRESSURE = 1u << 1;
+    static constexpr uint32_t HEADER_FLAG_MIRRORED = 1u << 2;
+    static constexpr uint32_t HEADER_FLAG_UNINITIALIZED = 1u << 3;
+    static constexpr uint32_t HEADER_FLAG_COMPACT_SLOTS = 1u << 4;
     static constexpr uint32_t INIT_STATE_UNINITIALIZED = 0;
     static constexpr uint32_t INIT_STATE_LEGACY = 1;
     static constexpr uint32_t INIT_STATE_INITIALIZING = 2;
@@ -144,19 +642,66 @@ public:
      * 
      * @param size The size of the queue, must be a power of 2.
      * @param shm_name The name of the shared memory segment. If nullptr, the queue will use local memory.
+     * @param options Creation options, see queue_options.
      * 
      * @throws std::runtime_error if shared memory allocation fails.
-     * @throws std::invalid_argument if size is not a power of 2.
+     * @throws std::invalid_argument if size is not a power of 2, differs from the
+     *         static_capacity policy or the options are invalid.
+     */
+    SlickQueue(uint32_t size, const char* const shm_name = nullptr, const queue_options& options = {})
+        : SlickQueue(size, shm_name, options, std::span<std::byte>())
+    {}
+
+    /**
+     * @brief Construct a new local memory SlickQueue object in a caller-provided buffer
+     *
+     * @param size The size of the queue, must be a power of 2.
+     * @param buffer Memory for the queue, at least buffer_size(size, options) bytes aligned to
+     *        buffer_alignment. It must outlive the queue, which never frees it.
+     * @param options Creation options, see queue_options.
+     *
+     * @throws std::invalid_argument if the buffer is too small or misaligned, or the options are invalid.
      */
-    SlickQueue(uint32_t size, const char* const shm_name = nullptr)
+    SlickQueue(uint32_t size, std::span<std::byte> buffer, const queue_options& options = {})
+        : SlickQueue(size, nullptr, options, buffer)
+    {}
+
+private:
+    SlickQueue(uint32_t size, const char* const shm_name, const queue_options& options, std::span<std::byte> buffer)
         : size_(size)
         , mask_(size ? size - 1 : 0)
-        , own_(shm_name == nullptr)
+        , own_(shm_name == nullptr && !buffer.data())
         , use_shm_(shm_name != nullptr)
     {
         if (!is_power_of_two(size_)) {
             throw std::invalid_argument("size must power of 2");
         }
+        if (static_capacity_ != 0 && size_ != static_capacity_) {
+            throw std::invalid_argument("size " + std::to_string(size_) + " differs from static capacity " +
+                std::to_string(static_capacity_));
+        }
+        prefetch_distance_ = options.prefetch_distance;
+        set_layout(options.layout, options.mapping);
+        scan_last_published_ = !options.track_last_published;
+        if (options.backpressure) {
+            if (options.max_consumers == 0) {
+                throw std::invalid_argument("backpressure requires max_consumers > 0");
+            }
+            backpressure_ = true;
+            max_consumers_ = options.max_consumers;
+        }
+        if (options.mirrored) {
+            validate_mirror();
+            mirrored_ = true;
+        }
+        huge_pages_ = options.huge_pages;
+        set_numa_policy(options.numa, options.numa_node);
+        uninitialized_ = options.uninitialized;
+        if constexpr (!std::is_default_constructible_v<T>) {
+            if (!uninitialized_) {
+                throw std::invalid_argument("T is not default constructible, create the queue with queue_options::uninitialized");
+            }
+        }
         if (shm_name) {
             allocate_shm_data(shm_name, false);
         } else {
@@ -164,30 +709,109 @@ public:
             reserved_->store(0, std::memory_order_relaxed);
             last_published_ = &last_published_local_;
             last_published_->store(kInvalidIndex, std::memory_order_relaxed);
-            last_published_valid_ = true;
-            data_ = new T[size_];
-            control_ = new slot[size_];
+            last_published_valid_ = !scan_last_published_;
+            reset_epoch_ = &reset_epoch_local_;
+            reset_limit_ = &reset_limit_local_;
+            consumer_count_ = &consumer_count_local_;
+            use_local_wait_state(true);
+            if (buffer.data() || options.memory_resource) {
+                if (mirrored_ || huge_pages_ || numa_ != numa_policy::none) {
+                    throw std::invalid_argument("mirrored, huge_pages and numa cannot be combined with a memory resource or buffer");
+                }
+            }
+            resource_ = buffer.data() ? nullptr :
+                options.memory_resource ? options.memory_resource : std::pmr::new_delete_resource();
+            allocate_local_data(buffer);
         }
+        init_producer_state();
+        warm_up_memory(options.warm_up);
+    }
+
+public:
+
+    /**
+     * @brief Construct a new local memory SlickQueue object with creation options
+     * 
+     * @param size The size of the queue, must be a power of 2.
+     * @param options Creation options, see queue_options.
+     * 
+     * @throws std::invalid_argument if size is not a power of 2.
+     */
+    SlickQueue(uint32_t size, const queue_options& options)
+        : SlickQueue(size, nullptr, options)
+    {}
+
+    /**
+     * @brief Construct a new local memory SlickQueue object of the static_capacity size
+     *
+     * @param options Creation options, see queue_options.
+     */
+    explicit SlickQueue(const queue_options& options = {}) requires (static_capacity_ != 0)
+        : SlickQueue(static_capacity_, nullptr, options)
+    {}
+
+    /**
+     * @brief Alignment of the buffer passed to SlickQueue(size, buffer, options), at least a cache line
+     */
+    static constexpr std::size_t buffer_alignment = record_align;
+
+    /**
+     * @brief Get the bytes a local queue occupies in a caller buffer or memory resource
+     * @param size The size of the queue
+     * @param options Creation options the queue will be created with
+     * @return Size of the block holding the consumer cursors, control and data arrays
+     */
+    static std::size_t buffer_size(uint32_t size, const queue_options& options = {}) noexcept {
+        auto layout = value_in_slot_ ? queue_layout::packed : options.layout;
+        return local_block_layout(
+            options.backpressure ? static_cast<std::size_t>(GATING_STRIDE) * options.max_consumers : 0,
+            control_stride_for(layout, options.mapping) * size,
+            layout == queue_layout::separate ? sizeof(T) * size : 0,
+            options.uninitialized && track_occupancy ? size : 0).size;
     }
 
     /**
      * @brief Open an existing SlickQueue in shared memory
      * 
      * @param shm_name The name of the shared memory segment.
+     * @param warm_up Prefault and lock the segment in this process, see warm_up_options.
      * 
      * @throws std::runtime_error if shared memory allocation fails or the segment does not exist.
      */
-    SlickQueue(const char* const shm_name)
+    SlickQueue(const char* const shm_name, const warm_up_options& warm_up = {})
         : size_(0)
         , mask_(0)
         , own_(false)
         , use_shm_(true)
     {
         allocate_shm_data(shm_name, true);
+        init_producer_state();
+        warm_up_memory(warm_up);
     }
 
     virtual ~SlickQueue() noexcept {
+        close_notifier();
+        if (locked_) {
+            for_each_region([](uint8_t* memory, std::size_t bytes) {
+#if defined(__linux__)
+                ::munlock(memory, bytes);
+#else
+                (void)memory;
+                (void)bytes;
+#endif
+                return true;
+            }, true);
+        }
         if (use_shm_) {
+            unmap_mirror();
+#if defined(__linux__)
+            if (!huge_path_.empty()) {
+                ::munmap(mapped_, mapped_bytes_);
+                if (own_) {
+                    ::unlink(huge_path_.c_str());
+                }
+            }
+#endif
             // slick-shm RAII handles unmapping and closing automatically
             // Only need to explicitly remove on POSIX if we're the owner
 #if !defined(_MSC_VER)
@@ -197,10 +821,7 @@ public:
 #endif
             // shm_ destructor unmaps and closes handle automatically
         } else {
-            delete[] data_;
-            data_ = nullptr;
-            delete[] control_;
-            control_ = nullptr;
+            free_local_data();
         }
     }
 
@@ -220,7 +841,125 @@ public:
      * @brief Get the size of the queue
      * @return Size of the queue
      */
-    constexpr uint32_t size() const noexcept { return size_; }
+    constexpr uint32_t size() const noexcept { return ring_size(); }
+
+    /**
+     * @brief Get the memory layout of the queue
+     * @return Layout of the control and data arrays
+     */
+    queue_layout layout() const noexcept { return layout_; }
+
+    /**
+     * @brief Get the index-to-slot mapping of the control array
+     * @return Slot mapping mode
+     */
+    slot_mapping mapping() const noexcept { return mapping_; }
+
+    /**
+     * @brief Check if publish() maintains the last published index
+     * @return true if read_last() is O(1), false if it scans the control array
+     */
+    bool tracks_last_published() const noexcept { return last_published_valid_; }
+
+    /**
+     * @brief Check if the data array is mapped twice back to back
+     * @return true if reservations never wrap and read() returns contiguous data across the ring end
+     */
+    bool mirrored() const noexcept { return mirrored_; }
+
+    /**
+     * @brief Check if control slots use the 8-byte encoding of the compact_slots policy
+     * @return true if each control slot is a single word holding sequence and size
+     */
+    static constexpr bool compact_slots() noexcept { return compact_slots_; }
+
+    /**
+     * @brief Set the software prefetch distance of this instance, see queue_options::prefetch_distance
+     * @param slots Slots to prefetch ahead, 0 to disable
+     *
+     * Not thread-safe; set it before the instance is used to read or produce.
+     */
+    void set_prefetch_distance(uint32_t slots) noexcept { prefetch_distance_ = slots; }
+
+    /**
+     * @brief Get the software prefetch distance of this instance
+     * @return Slots prefetched ahead, 0 when prefetching is off
+     */
+    uint32_t prefetch_distance() const noexcept { return prefetch_distance_; }
+
+    /**
+     * @brief Get the kind of pages backing the arrays
+     * @return page_backing::huge or transparent_huge if queue_options::huge_pages took effect
+     */
+    page_backing backing() const noexcept { return backing_; }
+
+    /**
+     * @brief Get the size of the pages backing the arrays
+     * @return Huge page size with page_backing::huge, the base page size otherwise
+     */
+    std::size_t page_size() const noexcept { return backing_page_size_; }
+
+    /**
+     * @brief Count the pages of the queue memory resident on each NUMA node
+     * @return Number of base pages indexed by node, empty if placement cannot be queried
+     *
+     * Covers the control and data arrays, and for shared memory the whole segment. Only pages
+     * mapped into this process are counted, so an attacher sees the pages it has touched.
+     */
+    std::vector<std::size_t> numa_placement() const {
+        std::vector<std::size_t> pages;
+#if defined(__linux__)
+        auto count = [&pages](const void* memory, std::size_t bytes) {
+            constexpr unsigned long batch = 256;
+            const std::size_t page = base_page_size();
+            auto address = reinterpret_cast<std::size_t>(memory) & ~(page - 1);
+            const auto end = reinterpret_cast<std::size_t>(memory) + bytes;
+            void* addresses[batch];
+            int status[batch];
+            while (address < end) {
+                unsigned long n = 0;
+                for (; n < batch && address < end; ++n, address += page) {
+                    addresses[n] = reinterpret_cast<void*>(address);
+                }
+                if (::syscall(SYS_move_pages, 0, n, addresses, nullptr, status, 0) != 0) {
+                    return false;
+                }
+                for (unsigned long i = 0; i < n; ++i) {
+                    if (status[i] >= 0) {
+                        if (pages.size() <= static_cast<std::size_t>(status[i])) {
+                            pages.resize(static_cast<std::size_t>(status[i]) + 1);
+                        }
+                        ++pages[static_cast<std::size_t>(status[i])];
+                    }
+                }
+            }
+            return true;
+        };
+        if (!for_each_region(count, false)) {
+            pages.clear();
+        }
+#endif
+        return pages;
+    }
+
+    /**
+     * @brief Check if warm_up_options::lock pinned the queue memory
+     * @return true if mlock() succeeded for every region, false if not requested or refused
+     *         (RLIMIT_MEMLOCK)
+     */
+    bool locked() const noexcept { return locked_; }
+
+    /**
+     * @brief Get the time the constructor spent in warm-up
+     * @return Duration of prefault and lock, zero if no warm-up was requested
+     */
+    std::chrono::nanoseconds warm_up_time() const noexcept { return warm_up_time_; }
+
+    /**
+     * @brief Check if producers are gated by registered consumer cursors
+     * @return true if the queue is non-lossy, false if older data may be overwritten
+     */
+    bool backpressure() const noexcept { return backpressure_; }
 
     
     /**
@@ -247,265 +986,2416 @@ public:
      * @brief Reserve space in the queue for writing
      * @param n Number of slots to reserve, default is 1
      * @return The starting index of the reserved space
+     *
+     * In backpressure mode this waits until the slowest registered consumer has committed
+     * the slots the reservation would overwrite.
      */
     uint64_t reserve(uint32_t n = 1) {
-        if (n == 0) [[unlikely]] {
-            throw std::invalid_argument("required size must be > 0");
-        }
-        if (n > size_) [[unlikely]] {
-            throw std::runtime_error("required size " + std::to_string(n) + " > queue size " + std::to_string(size_));
-        }
-        if (n == 1) {
-            constexpr reserved_info step = (1ULL << 16);
-            auto prev = reserved_->fetch_add(step, std::memory_order_release);
-            auto index = get_index(prev);
-            auto prev_size = get_size(prev);
-            if (prev_size != 1) {
-                auto expected = make_reserved_info(index + 1, prev_size);
-                reserved_->compare_exchange_strong(expected, make_reserved_info(index + 1, 1),
-                    std::memory_order_release, std::memory_order_relaxed);
-            }
-            return index;
-        }
-        auto reserved = reserved_->load(std::memory_order_relaxed);
-        uint64_t next = 0;
-        uint64_t index = 0;
-        bool buffer_wrapped = false;
-        for (;;) {
-            buffer_wrapped = false;
-            index = get_index(reserved);
-            auto idx = index & mask_;
-            if ((idx + n) > size_) {
-                // if there is no enough buffer left, start from the beginning
-                index += size_ - idx;
-                next = make_reserved_info(index + n, n);
-                buffer_wrapped = true;
-            }
-            else {
-                next = make_reserved_info(index + n, n);
-            }
-            if (reserved_->compare_exchange_weak(reserved, next, std::memory_order_release, std::memory_order_relaxed)) {
-                break;
-            }
-            cpu_relax();
-        }
-        if (buffer_wrapped) {
-            // queue wrapped, set current slock.data_index to the reserved index to let the reader
-            // know the next available data is in different slot.
-            auto& slot = control_[get_index(reserved) & mask_];
-            slot.size = n;
-            slot.data_index.store(index, std::memory_order_release);
-        }
-        return index;
+        validate_reservation(n);
+        return reserve_impl(n, true);
     }
 
     /**
-     * @brief Access the reserved space for writing
-     * @param index The index returned by reserve()
-     * @return Pointer to the reserved space
+     * @brief Reserve space in the queue for writing without waiting for consumers
+     * @param n Number of slots to reserve, default is 1
+     * @return The starting index of the reserved space, or std::nullopt if the reservation
+     *         would overwrite slots a registered consumer has not committed (backpressure mode only)
      */
-    T* operator[] (uint64_t index) noexcept {
-        return &data_[index & mask_];
+    std::optional<uint64_t> try_reserve(uint32_t n = 1) {
+        validate_reservation(n);
+        auto index = reserve_impl(n, false);
+        if (index == kInvalidIndex) {
+            return std::nullopt;
+        }
+        return index;
     }
 
     /**
-     * @brief Access the reserved space for writing (const version)
-     * @param index The index returned by reserve()
-     * @return Pointer to the reserved space
+     * @brief Producer handle that claims sequences in blocks, see make_producer()
+     *
+     * Not thread-safe: each producing thread owns its handle. Entries are published one by
+     * one as usual; flush() or destruction closes the unused tail of the current block.
      */
-    const T* operator[] (uint64_t index) const noexcept {
-        return &data_[index & mask_];
-    }
+    class producer {
+    public:
+        producer(producer&& other) noexcept
+            : queue_(other.queue_), block_(other.block_), next_(other.next_), end_(other.end_) {
+            other.next_ = other.end_ = 0;
+        }
 
-    /**
+        producer& operator=(producer&& other) noexcept {
+            if (this != &other) {
+                flush();
+                queue_ = other.queue_;
+                block_ = other.block_;
+                next_ = other.next_;
+                end_ = other.end_;
+                other.next_ = other.end_ = 0;
+            }
+            return *this;
+        }
+
+        producer(const producer&) = delete;
+        producer& operator=(const producer&) = delete;
+
+        ~producer() noexcept {
+            flush();
+        }
+
+        /**
+         * @brief Reserve one slot, claiming a new block from the queue when the current one is used up
+         * @return The index of the reserved slot
+         */
+        uint64_t reserve() noexcept {
+            if (next_ == end_) [[unlikely]] {
+                next_ = queue_->reserve_impl(block_, true);
+                end_ = next_ + block_;
+            }
+            auto distance = queue_->prefetch_distance_;
+            if (distance != 0 && next_ + distance < end_) {
+                // the block is owned by this handle, no other producer writes the slot
+                queue_->template prefetch_entry<true>(next_ + distance);
+            }
+            return next_++;
+        }
+
+        T* operator[](uint64_t index) noexcept {
+            return queue_->data_at(index);
+        }
+
+        template<typename... Args>
+        T* emplace(uint64_t index, Args&&... args) {
+            return queue_->emplace(index, std::forward<Args>(args)...);
+        }
+
+        void publish(uint64_t index) noexcept {
+            queue_->publish(index);
+        }
+
+        /**
+         * @brief Give back the unreserved tail of the current block
+         *
+         * Writes a skip marker at the first unused slot so readers jump to the end of the block
+         * instead of waiting on slots nobody will publish. Call it before a producer goes idle.
+         */
+        void flush() noexcept {
+            if (next_ != end_) {
+                queue_->store_slot(next_, end_, static_cast<uint32_t>(end_ - next_), std::memory_order_release);
+                queue_->notify_published();
+                next_ = end_;
+            }
+        }
+
+        uint32_t block() const noexcept { return block_; }
+
+    private:
+        friend class SlickQueue;
+        producer(SlickQueue* queue, uint32_t block) noexcept : queue_(queue), block_(block) {}
+
+        SlickQueue* queue_;
+        uint32_t block_;
+        uint64_t next_ = 0;
+        uint64_t end_ = 0;
+    };
+
+    /**
+     * @brief Create a producer handle that claims block sequences with a single reservation
+     * @param block Number of sequences claimed at once, must be smaller than the queue size
+     * @return Producer handle for the calling thread
+     *
+     * Many producers writing small messages otherwise serialize on the reservation cursor;
+     * a handle pays that RMW once per block and hands the sequences out with plain increments.
+     * Readers see the entries of different handles interleaved by block, and an unflushed
+     * block holds readers back at its first unpublished slot.
+     *
+     * @throws std::invalid_argument if block is 0 or not smaller than the queue size, or
+     *         exceeds 65535 slots with the compact_slots policy.
+     */
+    producer make_producer(uint32_t block = 64) {
+        if (block == 0 || block >= size_) {
+            throw std::invalid_argument("producer block must be > 0 and < queue size");
+        }
+        if (compact_slots_ && block > 0xFFFF) {
+            throw std::invalid_argument("producer blocks of compact slots are limited to 65535 slots");
+        }
+        return producer(this, block);
+    }
+
+    /**
+     * @brief Construct an element in place
+     * @param index The index returned by reserve(), or index + i within a multi-slot reservation
+     * @param args Arguments forwarded to the constructor of T
+     * @return Pointer to the constructed element
+     *
+     * Destroys the element that a previous lap left at the same position first. Required in
+     * queue_options::uninitialized mode, where operator[] points at raw storage.
+     */
+    template<typename... Args>
+    T* emplace(uint64_t index, Args&&... args) {
+        T* element = data_at(index);
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            return new (element) T(std::forward<Args>(args)...);
+        } else {
+            if (uninitialized_) {
+                auto& occupied = occupied_[index & ring_mask()];
+                if (occupied) {
+                    occupied = 0;
+                    element->~T();
+                }
+                new (element) T(std::forward<Args>(args)...);
+                occupied = 1;
+                return element;
+            }
+            element->~T();
+            try {
+                return new (element) T(std::forward<Args>(args)...);
+            } catch (...) {
+                if constexpr (std::is_default_constructible_v<T>) {
+                    new (element) T();  // the queue destroys every element on teardown
+                }
+                throw;
+            }
+        }
+    }
+
+    /**
+     * @brief Check if elements are constructed by emplace() only
+     * @return true if the queue was created with queue_options::uninitialized
+     */
+    bool uninitialized() const noexcept { return uninitialized_; }
+
+    /**
+     * @brief Access the reserved space for writing
+     * @param index The index returned by reserve()
+     * @return Pointer to the reserved space
+     */
+    T* operator[] (uint64_t index) noexcept {
+        return data_at(index);
+    }
+
+    /**
+     * @brief Access the reserved space for writing (const version)
+     * @param index The index returned by reserve()
+     * @return Pointer to the reserved space
+     */
+    const T* operator[] (uint64_t index) const noexcept {
+        return data_at(index);
+    }
+
+    /**
      * @brief Publish the data written in the reserved space
      * @param index The index returned by reserve()
      * @param n Number of slots to publish, default is 1
      */
     void publish(uint64_t index, uint32_t n = 1) noexcept {
         assert(n > 0);
-        auto& slot = control_[index & mask_];
-        slot.size = n;
-        slot.data_index.store(index, std::memory_order_release);
+        store_slot(index, index, n, std::memory_order_release);
+        update_last_published(index);
+        notify_published();
+    }
 
-        if (last_published_valid_) {
-            auto current = last_published_->load(std::memory_order_relaxed);
-            while ((current == kInvalidIndex || current < index) &&
-                   !last_published_->compare_exchange_weak(
-                       current, index, std::memory_order_release, std::memory_order_relaxed)) {
+    /**
+     * @brief Publish count consecutive single-slot entries starting at first
+     * @param first Index of the first entry, e.g. returned by reserve(count)
+     * @param count Number of entries to publish
+     *
+     * Every slot becomes its own entry, as if publish() was called for each index, but the
+     * sequence stores are made in one pass after a single release fence and the last
+     * published index is updated once.
+     */
+    void publish_range(uint64_t first, uint32_t count) noexcept {
+        if (count == 0) {
+            return;
+        }
+        if constexpr (!value_in_slot_ && !compact_slots_) {
+            for (uint64_t index = first; index < first + count; ++index) {
+                slot_at(index).size = 1;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint64_t index = first; index < first + count; ++index) {
+            store_sequence(index);
+        }
+        update_last_published(first + count - 1);
+        notify_published();
+    }
+
+    /**
+     * @brief Publish independently reserved single-slot entries
+     * @param indices Indices returned by reserve(), in any order
+     *
+     * Scatter form of publish_range(): one release fence, one pass over the control slots
+     * and one last published update for the whole list.
+     */
+    void publish(std::span<const uint64_t> indices) noexcept {
+        if (indices.empty()) {
+            return;
+        }
+        uint64_t newest = indices[0];
+        for (auto index : indices) {
+            if constexpr (!value_in_slot_ && !compact_slots_) {
+                slot_at(index).size = 1;
+            }
+            newest = index > newest ? index : newest;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (auto index : indices) {
+            store_sequence(index);
+        }
+        update_last_published(newest);
+        notify_published();
+    }
+
+    /**
+     * @brief Read data from the queue
+     * @param read_index Reference to the reading index, will be updated to the next index after reading
+     * @return Pair of pointer to the data and the size of the data, or nullptr and 0 if no data is available
+     */
+    std::pair<T*, uint32_t> read(uint64_t& read_index) noexcept {
+        uint64_t index;
+        uint32_t size;
+        while (true) {
+            auto idx = read_index & ring_mask();
+            index = load_slot(idx, size);
+
+#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
+            if (index != std::numeric_limits<uint64_t>::max() && index > read_index && ((index & ring_mask()) == idx)) {
+                loss_count_.fetch_add(index - read_index, std::memory_order_relaxed);
+            }
+#endif
+
+            if (index == std::numeric_limits<uint64_t>::max() || index < read_index) {
+                if (was_reset(read_index)) [[unlikely]] {
+                    read_index = 0;
+                    continue;
+                }
+                // data not ready yet
+                return std::make_pair(nullptr, 0);
+            }
+            else if (index > read_index && ((index & ring_mask()) != idx)) {
+                // queue wrapped, skip the unused slots
+                read_index = index;
+                continue;
+            }
+            break;
+        }
+
+        auto* data = data_at(read_index);
+        read_index = index + size;
+        return std::make_pair(data, size);
+    }
+
+    /**
+     * @brief Read all ready entries that are contiguous in memory
+     * @param read_index Reference to the reading index, will be updated past the returned entries
+     * @param max Maximum number of slots to return; the first entry is always returned whole
+     * @return Span over the slots of the ready entries, empty if no data is available
+     *
+     * The batch stops at the first unpublished slot, at a wrap marker, at an overwritten slot
+     * and at the physical end of the ring unless the queue is mirrored. Item boundaries of multi-slot reservations are not
+     * reported; use poll() when entries have different sizes. In the interleaved and packed layouts at
+     * most one entry is returned since elements are not contiguous.
+     */
+    std::span<T> read_batch(uint64_t& read_index, uint32_t max = std::numeric_limits<uint32_t>::max()) noexcept {
+        auto [first, first_size] = read(read_index);
+        if (!first) {
+            return {};
+        }
+        // prefetch d slots ahead of every entry added to the batch
+        if (prefetch_distance_ != 0) {
+            prefetch_entry<false>(read_index + prefetch_distance_ - 1);
+        }
+        uint32_t count = first_size;
+        if (layout_ == queue_layout::separate) {
+            while (count < max && (mirrored_ || (read_index & ring_mask()) != 0)) {
+                uint32_t size;
+                if (load_slot(read_index, size) != read_index) {
+                    break;
+                }
+                if (count + size > max) {
+                    break;
+                }
+                count += size;
+                read_index += size;
+                if (prefetch_distance_ != 0) {
+                    prefetch_entry<false>(read_index + prefetch_distance_ - 1);
+                }
+            }
+        }
+        return std::span<T>(first, count);
+    }
+
+    /**
+     * @brief Invoke a handler for each ready entry
+     * @param read_index Reference to the reading index, will be updated past the handled entries
+     * @param handler Callable invoked as handler(T* data, uint32_t size) for each entry
+     * @param max Maximum number of entries to handle
+     * @return Number of entries handled
+     *
+     * Polling stops at the first unpublished slot and at wrap markers; the next call picks
+     * up from there. read_index is advanced before the handler runs.
+     */
+    template<typename Handler>
+    uint32_t poll(uint64_t& read_index, Handler&& handler, uint32_t max = std::numeric_limits<uint32_t>::max()) {
+        if (max == 0) {
+            return 0;
+        }
+        auto [first, first_size] = read(read_index);
+        if (!first) {
+            return 0;
+        }
+        if (prefetch_distance_ != 0) {
+            prefetch_entry<false>(read_index + prefetch_distance_ - 1);
+        }
+        handler(first, first_size);
+        uint32_t count = 1;
+        while (count < max) {
+            uint32_t size;
+            if (load_slot(read_index, size) != read_index) {
+                break;
+            }
+            auto* data = data_at(read_index);
+            read_index += size;
+            if (prefetch_distance_ != 0) {
+                prefetch_entry<false>(read_index + prefetch_distance_ - 1);
+            }
+            handler(data, size);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Read data from the queue, waiting up to timeout for it to be published
+     * @tparam Wait Wait strategy, see blocking_wait and friends
+     * @param read_index Reference to the reading index, will be updated to the next index after reading
+     * @param timeout Maximum time to wait; zero polls once
+     * @return Pair of pointer to the data and the size of the data, or nullptr and 0 on timeout
+     */
+    template<typename Wait = relax_wait, typename Rep, typename Period>
+    std::pair<T*, uint32_t> read_wait(uint64_t& read_index, std::chrono::duration<Rep, Period> timeout) noexcept {
+        std::pair<T*, uint32_t> result{ nullptr, 0 };
+        wait_until<Wait>([&]() {
+            result = read(read_index);
+            return result.first != nullptr;
+        }, deadline_after(timeout));
+        return result;
+    }
+
+    /**
+     * @brief Wait until at least n entries are ready to be read from read_index
+     * @tparam Wait Wait strategy, see blocking_wait and friends
+     * @param read_index Reading index to wait on, not modified
+     * @param n Number of entries to wait for
+     * @param deadline Point in time to give up at
+     * @return true if n entries are ready, false on timeout
+     *
+     * Useful to batch work: a consumer can sleep until a full batch is available and then
+     * drain it with read_batch() or poll().
+     */
+    template<typename Wait = relax_wait>
+    bool wait_for(uint64_t read_index, uint32_t n, std::chrono::steady_clock::time_point deadline) noexcept {
+        return wait_until<Wait>([&]() { return ready_entries(read_index, n) >= n; }, deadline);
+    }
+
+    /**
+     * @brief Get a pollable file descriptor that becomes readable when the armed consumer has data
+     * @return File descriptor for poll/epoll/io_uring, owned by the queue
+     *
+     * Local queues use an eventfd. Shared memory queues bind an abstract unix datagram socket
+     * named after the segment, so producers in other processes signal it without passing fds.
+     * One consumer per queue owns the notifier. Producers only signal after arm_notifier(),
+     * and only once per arming, so publish() does not pay a syscall per message.
+     *
+     * Typical loop: read until empty, arm_notifier(cursor); if it returns false data arrived
+     * meanwhile, otherwise wait for the fd and drain_notifier() before reading again.
+     *
+     * @throws std::runtime_error if the notifier cannot be created, another process already
+     * owns it, the segment was created by v1.4 or earlier, or the platform is not Linux.
+     */
+    int notifier() {
+#if defined(__linux__)
+        int fd = notify_fd_.load(std::memory_order_acquire);
+        if (fd >= 0) {
+            return fd;
+        }
+        if (!shared_wait_state_) {
+            throw std::runtime_error("notifier requires a shared memory segment created by v1.5 or later");
+        }
+        if (use_shm_) {
+            sockaddr_un addr;
+            socklen_t len;
+            if (!notifier_address(addr, len)) {
+                throw std::runtime_error("shared memory name too long for a notifier");
+            }
+            fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                throw std::runtime_error("Failed to create notifier socket: " + std::string(std::strerror(errno)));
+            }
+            if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), len) != 0) {
+                auto error = errno;
+                ::close(fd);
+                throw std::runtime_error("Failed to bind notifier, is another consumer using it? " + std::string(std::strerror(error)));
+            }
+        } else {
+            fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fd < 0) {
+                throw std::runtime_error("Failed to create notifier eventfd: " + std::string(std::strerror(errno)));
+            }
+        }
+        int expected = -1;
+        if (!notify_fd_.compare_exchange_strong(expected, fd, std::memory_order_acq_rel)) {
+            ::close(fd);
+            return expected;
+        }
+        return fd;
+#else
+        throw std::runtime_error("notifier is only supported on Linux");
+#endif
+    }
+
+    /**
+     * @brief Ask producers to signal the notifier on the next publish
+     * @param read_index Reading index the consumer is about to wait on
+     * @return true if nothing is ready at read_index and the caller may wait on the notifier,
+     *         false if data arrived before the notifier was armed
+     */
+    bool arm_notifier(uint64_t read_index) noexcept {
+        assert(notify_fd_.load(std::memory_order_relaxed) >= 0);
+        notify_armed_->store(1, std::memory_order_relaxed);
+        // pairs with light_fence() in notify_published()
+        heavy_fence();
+        return ready_entries(read_index, 1) == 0;
+    }
+
+    /**
+     * @brief Consume pending notifier signals so the fd stops polling readable
+     */
+    void drain_notifier() noexcept {
+#if defined(__linux__)
+        int fd = notify_fd_.load(std::memory_order_acquire);
+        if (fd < 0) {
+            return;
+        }
+        if (use_shm_) {
+            char buffer[64];
+            while (::recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+            }
+        } else {
+            eventfd_t value;
+            ::eventfd_read(fd, &value);
+        }
+#endif
+    }
+
+    /**
+     * @brief Awaitable returned by async_read(), yields the same pair as read()
+     */
+    class read_awaiter : awaiter_node {
+    public:
+        bool await_ready() noexcept {
+            result_ = queue_->read(*read_index_);
+            return result_.first != nullptr;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            this->handle = handle;
+            this->read_index = *read_index_;
+            return queue_->suspend_awaiter(this);
+        }
+
+        std::pair<T*, uint32_t> await_resume() noexcept {
+            if (!result_.first) {
+                result_ = queue_->read(*read_index_);
+            }
+            return result_;
+        }
+
+    private:
+        friend class SlickQueue;
+        read_awaiter(SlickQueue* queue, uint64_t& read_index) noexcept : queue_(queue), read_index_(&read_index) {}
+
+        SlickQueue* queue_;
+        uint64_t* read_index_;
+        std::pair<T*, uint32_t> result_{ nullptr, 0 };
+    };
+
+    /**
+     * @brief Awaitable returned by async_read_batch(), yields the same span as read_batch()
+     */
+    class batch_awaiter : awaiter_node {
+    public:
+        bool await_ready() noexcept {
+            result_ = queue_->read_batch(*read_index_, max_);
+            return !result_.empty();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            this->handle = handle;
+            this->read_index = *read_index_;
+            return queue_->suspend_awaiter(this);
+        }
+
+        std::span<T> await_resume() noexcept {
+            if (result_.empty()) {
+                result_ = queue_->read_batch(*read_index_, max_);
+            }
+            return result_;
+        }
+
+    private:
+        friend class SlickQueue;
+        batch_awaiter(SlickQueue* queue, uint64_t& read_index, uint32_t max) noexcept
+            : queue_(queue), read_index_(&read_index), max_(max) {}
+
+        SlickQueue* queue_;
+        uint64_t* read_index_;
+        uint32_t max_;
+        std::span<T> result_;
+    };
+
+    /**
+     * @brief Read data from the queue, suspending the calling coroutine until it is published
+     * @param read_index Reference to the reading index, will be updated to the next index after reading
+     * @return Awaitable yielding the pair read() returns; nullptr only if the queue was reset meanwhile
+     *
+     * The awaiter lives in the coroutine frame and is linked into the queue while suspended,
+     * so no allocation happens per await. Without a scheduler the coroutine is only resumed by
+     * resume_ready(), on the thread calling it; publish() never runs consumer code. A coroutine
+     * must not be destroyed while suspended here.
+     */
+    read_awaiter async_read(uint64_t& read_index) noexcept {
+        return read_awaiter(this, read_index);
+    }
+
+    /**
+     * @brief Read data from the queue, suspending until it is published and resuming through a scheduler
+     * @param read_index Reference to the reading index, will be updated to the next index after reading
+     * @param scheduler Object with a noexcept schedule(std::coroutine_handle<>) called by publish()
+     *                  on the producing thread once the data is ready; it must queue the handle for
+     *                  the thread that owns the coroutine rather than resume it
+     *
+     * While scheduled awaiters are suspended, every publish() on this object takes the awaiter
+     * spinlock, which all producers contend on, and scans the whole awaiter list.
+     */
+    template<typename Scheduler>
+    read_awaiter async_read(uint64_t& read_index, Scheduler& scheduler) noexcept {
+        read_awaiter awaiter(this, read_index);
+        bind_scheduler(awaiter, scheduler);
+        return awaiter;
+    }
+
+    /**
+     * @brief Batch variant of async_read(), suspending until read_batch() has something to return
+     * @param read_index Reference to the reading index, will be updated past the returned entries
+     * @param max Maximum number of slots to return
+     */
+    batch_awaiter async_read_batch(uint64_t& read_index, uint32_t max = std::numeric_limits<uint32_t>::max()) noexcept {
+        return batch_awaiter(this, read_index, max);
+    }
+
+    /**
+     * @brief Batch variant of async_read() resuming through a scheduler, with the same cost to publish()
+     */
+    template<typename Scheduler>
+    batch_awaiter async_read_batch(uint64_t& read_index, uint32_t max, Scheduler& scheduler) noexcept {
+        batch_awaiter awaiter(this, read_index, max);
+        bind_scheduler(awaiter, scheduler);
+        return awaiter;
+    }
+
+    /**
+     * @brief Resume coroutines suspended in async_read() whose data is ready
+     * @return Number of coroutines resumed or scheduled
+     *
+     * Awaiters without a scheduler are resumed here, on the calling thread, e.g. an event loop
+     * after notifier() fired. Awaiters with a scheduler are handed to it; publish() on this
+     * SlickQueue object already does that for them, call it anyway when the data comes from
+     * producers in other processes or other SlickQueue objects on the same segment.
+     */
+    uint32_t resume_ready() noexcept {
+        return resume_awaiters(false);
+    }
+
+    /**
+     * @brief Read data from the queue using a shared atomic cursor
+     * @param read_index Reference to the atomic reading index, will be atomically updated after reading
+     * @return Pair of pointer to the data and the size of the data, or nullptr and 0 if no data is available
+     *
+     * This overload allows multiple consumers to share a single atomic cursor for load-balancing/work-stealing patterns.
+     * Each consumer atomically claims the next item to process.
+     */
+    std::pair<T*, uint32_t> read(std::atomic<uint64_t>& read_index) noexcept {
+        while (true) {
+            uint64_t current_index = read_index.load(std::memory_order_relaxed);
+            auto idx = current_index & ring_mask();
+            uint32_t size;
+            uint64_t index = load_slot(idx, size);
+
+            if (index == std::numeric_limits<uint64_t>::max() || index < current_index) {
+                if (was_reset(current_index)) [[unlikely]] {
+                    read_index.compare_exchange_weak(current_index, 0, std::memory_order_relaxed, std::memory_order_relaxed);
+                    continue;
+                }
+                // data not ready yet
+                return std::make_pair(nullptr, 0);
+            }
+
+#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
+            uint64_t overrun = 0;
+            if (index > current_index && ((index & ring_mask()) == idx)) {
+                overrun = index - current_index;
+            }
+#endif
+
+            if (index > current_index && ((index & ring_mask()) != idx)) {
+                // queue wrapped, skip the unused slots
+                read_index.compare_exchange_weak(current_index, index, std::memory_order_relaxed, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Try to atomically claim this item
+            uint64_t next_index = index + size;
+            if (read_index.compare_exchange_weak(current_index, next_index, std::memory_order_relaxed, std::memory_order_relaxed)) {
+#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
+                if (overrun != 0) {
+                    loss_count_.fetch_add(overrun, std::memory_order_relaxed);
+                }
+#endif
+                // Successfully claimed the item
+                return std::make_pair(data_at(current_index), size);
+            }
+            cpu_relax();
+            // CAS failed, another consumer claimed it, retry
+        }
+    }
+
+    /**
+     * @brief Claim a batch of ready entries from a shared atomic cursor with a single CAS
+     * @param read_index Reference to the atomic reading index, will be atomically advanced past the claimed entries
+     * @param max Maximum number of slots to claim; the first entry is always claimed whole
+     * @return Span over the claimed slots, empty if no data is available
+     *
+     * The batch size adapts to the backlog: the run of contiguous ready slots after the cursor
+     * is scanned up to max. A full run means a deep backlog and is claimed entirely; a shorter
+     * run is halved so the remaining entries stay available to other consumers. The same
+     * stopping rules as read_batch(uint64_t&, uint32_t) apply. max is not capped; the default
+     * of 64 slots only bounds how much one call may take.
+     */
+    std::span<T> read_batch(std::atomic<uint64_t>& read_index, uint32_t max = kDefaultClaimBatch) noexcept {
+        while (true) {
+            uint64_t current_index = read_index.load(std::memory_order_relaxed);
+            auto idx = current_index & ring_mask();
+            uint32_t size;
+            uint64_t index = load_slot(idx, size);
+
+            if (index == std::numeric_limits<uint64_t>::max() || index < current_index) {
+                if (was_reset(current_index)) [[unlikely]] {
+                    read_index.compare_exchange_weak(current_index, 0, std::memory_order_relaxed, std::memory_order_relaxed);
+                    continue;
+                }
+                // data not ready yet
+                return {};
+            }
+
+            if (index > current_index && ((index & ring_mask()) != idx)) {
+                // queue wrapped, skip the unused slots
+                read_index.compare_exchange_weak(current_index, index, std::memory_order_relaxed, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Scan the run of ready slots following the first entry
+            uint32_t count = size;
+            uint64_t next_index = index + count;
+            if (layout_ == queue_layout::separate) {
+                uint32_t ready = count;
+                uint64_t scan_index = next_index;
+                while (ready < max && (mirrored_ || (scan_index & ring_mask()) != 0)) {
+                    uint32_t scan_size;
+                    if (load_slot(scan_index, scan_size) != scan_index) {
+                        break;
+                    }
+                    if (ready + scan_size > max) {
+                        break;
+                    }
+                    ready += scan_size;
+                    scan_index += scan_size;
+                }
+                if (ready >= max) {
+                    // a full run is taken whole
+                    next_index = scan_index;
+                } else {
+                    // a short run is shared with other consumers: walk the first half again
+                    // to end the claim on an entry boundary
+                    uint32_t target = count + (ready - count + 1) / 2;
+                    while (next_index < scan_index) {
+                        uint32_t entry_size;
+                        if (load_slot(next_index, entry_size) != next_index ||
+                            next_index + entry_size - index > target) {
+                            break;
+                        }
+                        next_index += entry_size;
+                    }
+                }
+                count = static_cast<uint32_t>(next_index - index);
+            }
+
+            if (read_index.compare_exchange_weak(current_index, next_index, std::memory_order_relaxed, std::memory_order_relaxed)) {
+#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
+                if (index > current_index) {
+                    loss_count_.fetch_add(index - current_index, std::memory_order_relaxed);
+                }
+#endif
+                return std::span<T>(data_at(current_index), count);
+            }
+            cpu_relax();
+            // CAS failed, another consumer claimed part of the run, retry
+        }
+    }
+
+    /**
+    * @brief Read the last published data in the queue
+    * @return Pointer to the last published data, or nullptr if no data is available
+    */
+    std::pair<T*, uint32_t> read_last() noexcept {
+        if (last_published_valid_) {
+            auto last_index = last_published_->load(std::memory_order_acquire);
+            if (last_index == kInvalidIndex) {
+                return std::make_pair(nullptr, 0);
+            }
+            uint32_t size;
+            load_slot(last_index, size);
+            return std::make_pair(data_at(last_index), size);
+        }
+
+        if (scan_last_published_) {
+            // last published index is not tracked, walk back from the reservation cursor to
+            // the newest slot that was published at its own index
+            auto index = get_index(reserved_->load(std::memory_order_acquire));
+            auto lowest = index > ring_size() ? index - ring_size() : 0;
+            while (index > lowest) {
+                --index;
+                uint32_t size;
+                if (load_slot(index, size) == index) {
+                    return std::make_pair(data_at(index), size);
+                }
+            }
+            return std::make_pair(nullptr, 0);
+        }
+
+        // legacy
+        auto reserved = reserved_->load(std::memory_order_relaxed);
+        auto index = get_index(reserved);
+        if (index == 0) {
+            return std::make_pair(nullptr, 0);
+        }
+        auto sz = get_size(reserved);
+        auto last_index = index - sz;
+        return std::make_pair(data_at(last_index), sz);
+    }
+
+    /**
+     * @brief Register a consumer cursor that gates producers in backpressure mode
+     * @param start_index Index the consumer starts reading from, must not be behind the
+     *        oldest slot still in the queue
+     * @return Consumer id to pass to commit() and unregister_consumer()
+     *
+     * @throws std::runtime_error if backpressure is disabled or all cursors are taken.
+     */
+    uint32_t register_consumer(uint64_t start_index) {
+        if (!backpressure_) {
+            throw std::runtime_error("register_consumer requires backpressure mode");
+        }
+        // counted before the cursor is set so producers never skip a registered cursor
+        consumer_count_->fetch_add(1, std::memory_order_acq_rel);
+        for (uint32_t i = 0; i < max_consumers_; ++i) {
+            uint64_t expected = kInvalidIndex;
+            if (gating_at(i).compare_exchange_strong(expected, start_index, std::memory_order_acq_rel)) {
+                return i;
+            }
+        }
+        consumer_count_->fetch_sub(1, std::memory_order_release);
+        throw std::runtime_error("all " + std::to_string(max_consumers_) + " consumer cursors are registered");
+    }
+
+    /**
+     * @brief Register a consumer cursor starting at initial_reading_index()
+     * @return Consumer id to pass to commit() and unregister_consumer()
+     */
+    uint32_t register_consumer() {
+        return register_consumer(initial_reading_index());
+    }
+
+    /**
+     * @brief Release a consumer cursor so it no longer gates producers
+     * @param consumer Id returned by register_consumer()
+     */
+    void unregister_consumer(uint32_t consumer) noexcept {
+        assert(consumer < max_consumers_);
+        if (gating_at(consumer).exchange(kInvalidIndex, std::memory_order_acq_rel) != kInvalidIndex) {
+            consumer_count_->fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Mark everything before read_index as consumed so producers may overwrite it
+     * @param consumer Id returned by register_consumer()
+     * @param read_index The reading index after the last processed read()
+     *
+     * Commit only after the data returned by read() is no longer used.
+     */
+    void commit(uint32_t consumer, uint64_t read_index) noexcept {
+        assert(consumer < max_consumers_);
+        gating_at(consumer).store(read_index, std::memory_order_release);
+    }
+
+    /**
+     * @brief Reset the queue, invalidating all existing data
+     * 
+     * Note: This function is not thread-safe and should be called when no other threads are accessing the queue.
+     */
+    void reset() noexcept {
+        for (uint32_t i = 0; i < size_; ++i) {
+            construct_slot(i);
+        }
+        // cursors up to the discarded reservation point may be stranded past the new one
+        auto discarded = get_index(reserved_->load(std::memory_order_relaxed));
+        if (discarded > reset_limit_->load(std::memory_order_relaxed)) {
+            reset_limit_->store(discarded, std::memory_order_relaxed);
+        }
+        reserved_->store(0, std::memory_order_release);
+        last_published_->store(kInvalidIndex, std::memory_order_relaxed);
+        reset_epoch_->fetch_add(1, std::memory_order_release);
+        producer_index_ = 0;
+        producer_last_published_ = kInvalidIndex;
+        for (uint32_t i = 0; i < max_consumers_; ++i) {
+            auto& cursor = gating_at(i);
+            if (cursor.load(std::memory_order_relaxed) != kInvalidIndex) {
+                cursor.store(0, std::memory_order_relaxed);
+            }
+        }
+        gating_cache_.store(0, std::memory_order_relaxed);
+#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
+        loss_count_.store(0, std::memory_order_relaxed);
+#endif
+    }
+
+private:
+    void validate_reservation(uint32_t n) const {
+        if (n == 0) [[unlikely]] {
+            throw std::invalid_argument("required size must be > 0");
+        }
+        if (n > ring_size()) [[unlikely]] {
+            throw std::runtime_error("required size " + std::to_string(n) + " > queue size " + std::to_string(ring_size()));
+        }
+        if (n > 1 && layout_ != queue_layout::separate) [[unlikely]] {
+            throw std::invalid_argument("multi-slot reservations require the separate layout");
+        }
+        if (compact_slots_ && n > 0xFFFF) [[unlikely]] {
+            throw std::invalid_argument("reservations of compact slots are limited to 65535 slots");
+        }
+    }
+
+    // Returns kInvalidIndex only when wait is false and backpressure refuses the claim
+    uint64_t reserve_impl(uint32_t n, bool wait) noexcept {
+        if constexpr (single_producer_) {
+            uint64_t index = producer_index_;
+            uint64_t marker = kInvalidIndex;
+            auto idx = index & ring_mask();
+            if (!mirrored_ && (idx + n) > ring_size()) {
+                // if there is no enough buffer left, start from the beginning
+                marker = index;
+                index += ring_size() - idx;
+            }
+            if (backpressure_) {
+                for (uint32_t spins = 0; !has_capacity(index + n); ++spins) {
+                    if (!wait) {
+                        return kInvalidIndex;
+                    }
+                    backoff(spins);
+                }
+            }
+            producer_index_ = index + n;
+            reserved_->store(make_reserved_info(producer_index_, n), std::memory_order_release);
+            if (prefetch_distance_ != 0) {
+                prefetch_entry<true>(producer_index_ + prefetch_distance_ - 1);
+            }
+            if (marker != kInvalidIndex) {
+                store_slot(marker, index, n, std::memory_order_release);
+            }
+            return index;
+        }
+        if (n == 1 && !backpressure_) {
+            constexpr reserved_info step = (1ULL << 16);
+            auto prev = reserved_->fetch_add(step, std::memory_order_release);
+            auto index = get_index(prev);
+            auto prev_size = get_size(prev);
+            if (prev_size != 1) {
+                auto expected = make_reserved_info(index + 1, prev_size);
+                reserved_->compare_exchange_strong(expected, make_reserved_info(index + 1, 1),
+                    std::memory_order_release, std::memory_order_relaxed);
+            }
+            return index;
+        }
+        auto reserved = reserved_->load(std::memory_order_relaxed);
+        uint64_t next = 0;
+        uint64_t index = 0;
+        bool buffer_wrapped = false;
+        uint32_t spins = 0;
+        for (;;) {
+            buffer_wrapped = false;
+            index = get_index(reserved);
+            auto idx = index & ring_mask();
+            if (!mirrored_ && (idx + n) > ring_size()) {
+                // if there is no enough buffer left, start from the beginning
+                index += ring_size() - idx;
+                next = make_reserved_info(index + n, n);
+                buffer_wrapped = true;
+            }
+            else {
+                next = make_reserved_info(index + n, n);
+            }
+            if (backpressure_ && !has_capacity(index + n)) {
+                if (!wait) {
+                    return kInvalidIndex;
+                }
+                backoff(spins++);
+                reserved = reserved_->load(std::memory_order_relaxed);
+                continue;
+            }
+            if (reserved_->compare_exchange_weak(reserved, next, std::memory_order_release, std::memory_order_relaxed)) {
+                break;
+            }
+            cpu_relax();
+        }
+        if (buffer_wrapped) {
+            // queue wrapped, set current slock.data_index to the reserved index to let the reader
+            // know the next available data is in different slot.
+            store_slot(get_index(reserved), index, n, std::memory_order_release);
+        }
+        return index;
+    }
+
+    // single_producer continues from the segment's current cursor when attaching
+    void init_producer_state() noexcept {
+        producer_index_ = get_index(reserved_->load(std::memory_order_acquire));
+        producer_last_published_ = last_published_valid_ ? last_published_->load(std::memory_order_acquire) : kInvalidIndex;
+    }
+
+    // Capacity and index mask, compile-time constants with the static_capacity policy
+    constexpr uint32_t ring_size() const noexcept {
+        if constexpr (static_capacity_ != 0) {
+            return static_capacity_;
+        } else {
+            return size_;
+        }
+    }
+
+    constexpr uint32_t ring_mask() const noexcept {
+        if constexpr (static_capacity_ != 0) {
+            return static_capacity_ - 1;
+        } else {
+            return mask_;
+        }
+    }
+
+    // Linear slots of the separate and packed layouts are indexed with the slot size, padded,
+    // swizzled and interleaved control arrays take the runtime stride and swizzle
+    uint8_t* slot_address(uint64_t index) const noexcept {
+        uint64_t idx = index & ring_mask();
+        if (linear_slots_) [[likely]] {
+            return control_ + idx * slot_bytes();
+        }
+        idx = ((idx & swizzle_mask_) << swizzle_shift_) | (idx >> swizzle_bits_);
+        return control_ + idx * control_stride_;
+    }
+
+    slot& slot_at(uint64_t index) const noexcept {
+        return *reinterpret_cast<slot*>(slot_address(index));
+    }
+
+    void construct_slot(uint64_t index) noexcept {
+        if constexpr (compact_slots_) {
+            new (slot_address(index)) compact_slot(kInvalidIndex);
+        } else {
+            new (slot_address(index)) slot();
+        }
+    }
+
+    // Sequence published in the slot of index, kInvalidIndex if none, and the size published with it
+    uint64_t load_slot(uint64_t index, uint32_t& size) const noexcept {
+        if constexpr (compact_slots_) {
+            auto word = reinterpret_cast<compact_slot*>(slot_address(index))->load(std::memory_order_acquire);
+            size = get_size(word);
+            return word == kInvalidIndex ? kInvalidIndex : get_index(word);
+        }
+        auto& s = slot_at(index);
+        auto data_index = s.data_index.load(std::memory_order_acquire);
+        size = entry_size(s);
+        return data_index;
+    }
+
+    // Publish data_index with size in the slot of index, the size is stored first in wide slots
+    void store_slot(uint64_t index, uint64_t data_index, uint32_t size, std::memory_order order) noexcept {
+        if constexpr (compact_slots_) {
+            reinterpret_cast<compact_slot*>(slot_address(index))->store(make_reserved_info(data_index, size), order);
+        } else {
+            auto& s = slot_at(index);
+            if constexpr (!value_in_slot_) {
+                s.size = size;
+            }
+            s.data_index.store(data_index, order);
+        }
+    }
+
+    // Relaxed store of a single-slot entry after the caller's release fence; wide slots
+    // must have their size written before the fence
+    void store_sequence(uint64_t index) noexcept {
+        if constexpr (compact_slots_) {
+            reinterpret_cast<compact_slot*>(slot_address(index))->store(make_reserved_info(index, 1), std::memory_order_relaxed);
+        } else {
+            slot_at(index).data_index.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    // Bytes of one control slot before padding
+    static constexpr std::size_t slot_bytes() noexcept {
+        return compact_slots_ ? sizeof(compact_slot) : sizeof(slot);
+    }
+
+    // The separate layout indexes with the compile-time sizeof(T), only interleaved records
+    // take the record stride
+    T* data_at(uint64_t index) const noexcept {
+        if constexpr (value_in_slot_) {
+            return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(&slot_at(index)) + slot_value_offset);
+        } else {
+            if (layout_ == queue_layout::separate) [[likely]] {
+                return reinterpret_cast<T*>(data_) + (index & ring_mask());
+            }
+            return reinterpret_cast<T*>(data_ + (index & ring_mask()) * record_size);
+        }
+    }
+
+    // Prefetch the control slot and every cache line of the element of index
+    template<bool Write>
+    void prefetch_entry(uint64_t index) const noexcept {
+        auto prefetch = [](const void* address) {
+            if constexpr (Write) {
+                prefetch_write(address);
+            } else {
+                prefetch_read(address);
+            }
+        };
+        prefetch(slot_address(index));
+        if constexpr (!value_in_slot_) {
+            auto begin = reinterpret_cast<uintptr_t>(data_at(index)) & ~(uintptr_t(cacheline_size) - 1);
+            auto end = reinterpret_cast<uintptr_t>(data_at(index)) + sizeof(T);
+            for (auto line = begin; line < end; line += cacheline_size) {
+                prefetch(reinterpret_cast<const void*>(line));
+            }
+        }
+    }
+
+    // Slots taken by the entry published in s; the packed layout stores the element over the size
+    uint32_t entry_size(const slot& s) const noexcept {
+        if constexpr (value_in_slot_) {
+            (void)s;
+            return 1;
+        } else {
+            return s.size;
+        }
+    }
+
+    void set_layout(queue_layout layout, slot_mapping mapping) {
+        if constexpr (value_in_slot_) {
+            // the policy fixes the layout, the default separate layout is taken to mean packed
+            if (layout == queue_layout::separate) {
+                layout = queue_layout::packed;
+            }
+            if (layout != queue_layout::packed) {
+                throw std::invalid_argument("value_in_slot requires the packed layout");
+            }
+        } else if (layout == queue_layout::packed) {
+            throw std::invalid_argument("packed layout requires the value_in_slot policy");
+        }
+        if (compact_slots_ && layout != queue_layout::separate) {
+            throw std::invalid_argument("compact slots require the separate layout");
+        }
+        switch (layout) {
+        case queue_layout::separate:
+        case queue_layout::packed:
+            break;
+        case queue_layout::interleaved:
+            if (mapping != slot_mapping::linear) {
+                throw std::invalid_argument("interleaved layout requires linear slot mapping");
+            }
+            break;
+        default:
+            throw std::invalid_argument("unknown queue layout " + std::to_string(static_cast<uint32_t>(layout)));
+        }
+
+        control_stride_ = control_stride_for(layout, mapping);
+        swizzle_mask_ = 0;
+        swizzle_bits_ = 0;
+        swizzle_shift_ = 0;
+        switch (mapping) {
+        case slot_mapping::linear:
+        case slot_mapping::padded:
+            break;
+        case slot_mapping::swizzled: {
+            const uint32_t slots_per_line = static_cast<uint32_t>(cacheline_size / slot_bytes());
+            if (size_ >= slots_per_line) {
+                while ((1u << swizzle_bits_) < slots_per_line) {
+                    ++swizzle_bits_;
+                }
+                uint32_t size_bits = 0;
+                while ((1u << size_bits) < size_) {
+                    ++size_bits;
+                }
+                swizzle_mask_ = (1u << swizzle_bits_) - 1;
+                swizzle_shift_ = size_bits - swizzle_bits_;
+            }
+            break;
+        }
+        default:
+            throw std::invalid_argument("unknown slot mapping " + std::to_string(static_cast<uint32_t>(mapping)));
+        }
+        layout_ = layout;
+        mapping_ = mapping;
+        linear_slots_ = mapping == slot_mapping::linear && layout != queue_layout::interleaved;
+    }
+
+    // Bytes needed for the control and data arrays
+    std::size_t arrays_size() const noexcept {
+        if (layout_ == queue_layout::interleaved) {
+            return record_size * size_;
+        }
+        if (layout_ == queue_layout::packed) {
+            return control_stride_ * size_;
+        }
+        return (control_stride_ + sizeof(T)) * size_;
+    }
+
+    // Stride of the control array, see set_layout()
+    static constexpr std::size_t control_stride_for(queue_layout layout, slot_mapping mapping) noexcept {
+        if (layout == queue_layout::interleaved) {
+            return record_size;
+        }
+        return mapping == slot_mapping::padded ? align_up(slot_bytes(), cacheline_size) : slot_bytes();
+    }
+
+    // Offsets of a local block: [gating cursors][control array][data array][occupancy],
+    // every part but the occupancy bytes starting on a buffer_alignment boundary
+    struct local_block {
+        std::size_t control = 0;
+        std::size_t data = 0;
+        std::size_t occupancy = 0;
+        std::size_t size = 0;
+    };
+
+    static constexpr local_block local_block_layout(std::size_t gating_bytes, std::size_t control_bytes,
+        std::size_t data_bytes, std::size_t occupancy_bytes) noexcept {
+        local_block block;
+        block.control = align_up(gating_bytes, record_align);
+        block.data = align_up(block.control + control_bytes, record_align);
+        block.occupancy = block.data + data_bytes;
+        block.size = align_up(block.occupancy + occupancy_bytes, record_align);
+        return block;
+    }
+
+    local_block local_block_layout() const noexcept {
+        return local_block_layout(gating_size(), control_stride_ * size_,
+            layout_ == queue_layout::separate ? sizeof(T) * size_ : 0,
+            uninitialized_ && track_occupancy ? size_ : 0);
+    }
+
+    // Bytes needed for the consumer gating cursors
+    std::size_t gating_size() const noexcept {
+        return backpressure_ ? static_cast<std::size_t>(GATING_STRIDE) * max_consumers_ : 0;
+    }
+
+    // Offset of the arrays in the shared memory segment
+    std::size_t arrays_offset() const noexcept {
+        std::size_t offset = header_size_ + gating_size();
+        if (layout_ == queue_layout::interleaved) {
+            return align_up(offset, record_align);
+        }
+        return offset;
+    }
+
+    // Offset of the page aligned data array in a mirrored shared memory segment
+    std::size_t mirrored_data_offset() const noexcept {
+        return align_up(arrays_offset() + control_stride_ * size_, backing_page_size_);
+    }
+
+    static constexpr bool track_occupancy = !std::is_trivially_destructible_v<T>;
+
+    // Offset of the occupancy array, right after the data array
+    std::size_t occupancy_offset() const noexcept {
+        if (mirrored_) {
+            return mirrored_data_offset() + sizeof(T) * size_;
+        }
+        return arrays_offset() + arrays_size();
+    }
+
+    // Bytes of the shared memory segment
+    std::size_t segment_size() const noexcept {
+        return occupancy_offset() + (uninitialized_ && track_occupancy ? size_ : 0);
+    }
+
+    std::atomic<uint64_t>& gating_at(uint32_t consumer) const noexcept {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(gating_ + static_cast<std::size_t>(consumer) * GATING_STRIDE);
+    }
+
+    void construct_gating() noexcept {
+        for (uint32_t i = 0; i < max_consumers_; ++i) {
+            new (&gating_at(i)) std::atomic<uint64_t>(kInvalidIndex);
+        }
+    }
+
+    // Slowest registered consumer cursor, kInvalidIndex if no consumer is registered
+    uint64_t min_gating_sequence() const noexcept {
+        uint64_t min_cursor = kInvalidIndex;
+        for (uint32_t i = 0; i < max_consumers_; ++i) {
+            auto cursor = gating_at(i).load(std::memory_order_acquire);
+            if (cursor < min_cursor) {
+                min_cursor = cursor;
+            }
+        }
+        return min_cursor;
+    }
+
+    // Check that claiming up to (but excluding) end does not overwrite unconsumed slots
+    bool has_capacity(uint64_t end) noexcept {
+        if (end <= gating_cache_.load(std::memory_order_relaxed) + ring_size()) {
+            return true;
+        }
+        // without registered consumers nothing gates, skip the cursor scan
+        if (consumer_count_->load(std::memory_order_acquire) == 0) {
+            return true;
+        }
+        auto gate = min_gating_sequence();
+        if (gate == kInvalidIndex) {
+            return true;
+        }
+        gating_cache_.store(gate, std::memory_order_relaxed);
+        return end <= gate + ring_size();
+    }
+
+    void map_occupancy(uint8_t* base) noexcept {
+        occupied_ = uninitialized_ && track_occupancy ? base + occupancy_offset() : nullptr;
+    }
+
+    // Point control_ and data_ into a contiguous block of arrays_size() bytes
+    void map_arrays(uint8_t* base) noexcept {
+        control_ = base;
+        if (layout_ == queue_layout::interleaved) {
+            data_ = base + record_data_offset;
+        } else if (layout_ == queue_layout::packed) {
+            data_ = base + slot_value_offset;  // element 0 with linear mapping, see data_at()
+        } else {
+            data_ = base + control_stride_ * size_;
+        }
+    }
+
+    // Elements are default-initialized like new T[size], trivial ones are not touched at all so
+    // that freshly allocated and mapped data pages stay unfaulted until first use
+    void construct_arrays() {
+        for (uint32_t i = 0; i < size_; ++i) {
+            construct_slot(i);
+        }
+        if constexpr (std::is_default_constructible_v<T> && !std::is_trivially_default_constructible_v<T>) {
+            if (!uninitialized_) {
+                uint32_t i = 0;
+                try {
+                    for (; i < size_; ++i) {
+                        new (data_at(i)) T;
+                    }
+                } catch (...) {
+                    // leave no live element behind, the caller releases the storage
+                    if constexpr (!std::is_trivially_destructible_v<T>) {
+                        while (i > 0) {
+                            data_at(--i)->~T();
+                        }
+                    }
+                    throw;
+                }
+            }
+        }
+    }
+
+    // Destroy every live element, in uninitialized mode only those emplace() constructed
+    void destroy_elements() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (uint32_t i = 0; i < size_; ++i) {
+                if (!uninitialized_ || occupied_[i]) {
+                    data_at(i)->~T();
+                }
+            }
+        }
+    }
+
+    void allocate_local_data(std::span<std::byte> buffer) {
+#if defined(__linux__)
+        if (mirrored_ || huge_pages_ || numa_ != numa_policy::none) {
+            allocate_mapped_data();
+            return;
+        }
+#endif
+        auto block = local_block_layout();
+        if (buffer.data()) {
+            if (reinterpret_cast<std::uintptr_t>(buffer.data()) % buffer_alignment != 0) {
+                throw std::invalid_argument("buffer must be aligned to " + std::to_string(buffer_alignment) + " bytes");
+            }
+            if (buffer.size() < block.size) {
+                throw std::invalid_argument("buffer of " + std::to_string(buffer.size()) + " bytes < required " +
+                    std::to_string(block.size) + " bytes");
+            }
+            block_ = reinterpret_cast<uint8_t*>(buffer.data());
+        } else {
+            block_ = static_cast<uint8_t*>(resource_->allocate(block.size, buffer_alignment));
+        }
+        block_bytes_ = block.size;
+        if (backpressure_) {
+            gating_ = block_;
+            construct_gating();
+        }
+        if (layout_ == queue_layout::separate) {
+            control_ = block_ + block.control;
+            data_ = block_ + block.data;
+        } else {
+            map_arrays(block_ + block.control);
+        }
+        if (uninitialized_ && track_occupancy) {
+            occupied_ = block_ + block.occupancy;
+            std::memset(occupied_, 0, size_);
+        }
+        try {
+            construct_arrays();
+        } catch (...) {
+            free_local_data(false);
+            throw;
+        }
+    }
+
+    // Arrays in memory mapped by this instance, for mirrored rings, huge pages and NUMA placement
+    void allocate_mapped_data() {
+        if (backpressure_) {
+            gating_ = static_cast<uint8_t*>(::operator new(gating_size(), std::align_val_t{ GATING_STRIDE }));
+            construct_gating();
+        }
+        if (uninitialized_ && track_occupancy) {
+            occupied_ = new uint8_t[size_]();
+        }
+        if (!mirrored_) {
+            try {
+                map_arrays(map_anonymous(arrays_size()));
+                apply_numa(mapped_, mapped_bytes_);
+            } catch (...) {
+                free_local_data(false);
+                throw;
+            }
+            try {
+                construct_arrays();
+            } catch (...) {
+                free_local_data(false);
+                throw;
+            }
+            return;
+        }
+        // whole pages so the NUMA policy of the control array does not touch other allocations
+        const std::size_t control_bytes = align_up(control_stride_ * size_, base_page_size());
+        control_ = static_cast<uint8_t*>(::operator new(control_bytes, std::align_val_t{ base_page_size() }));
+        try {
+            apply_numa(control_, control_bytes);
+            map_local_mirror();
+            apply_numa(data_, 2 * sizeof(T) * size_);
+        } catch (...) {
+            ::operator delete(control_, std::align_val_t{ base_page_size() });
+            control_ = nullptr;
+            free_local_data(false);
+            throw;
+        }
+        try {
+            construct_arrays();
+        } catch (...) {
+            free_local_data(false);
+            throw;
+        }
+    }
+
+    // Release the arrays, destroying the elements first unless they were never constructed
+    void free_local_data(bool live_elements = true) noexcept {
+        if (block_) {
+            if (live_elements) {
+                destroy_elements();
+            }
+            if (resource_) {
+                resource_->deallocate(block_, block_bytes_, buffer_alignment);
+            }
+            block_ = nullptr;
+            gating_ = nullptr;
+            occupied_ = nullptr;
+            data_ = nullptr;
+            control_ = nullptr;
+            return;
+        }
+        if (gating_) {
+            ::operator delete(gating_, std::align_val_t{ GATING_STRIDE });
+            gating_ = nullptr;
+        }
+        if (mapped_) {
+            if (control_ && live_elements) {
+                destroy_elements();
+            }
+#if defined(__linux__)
+            ::munmap(mapped_, mapped_bytes_);
+#endif
+            mapped_ = nullptr;
+        } else if (mirrored_) {
+            if (control_) {
+                if (live_elements) {
+                    destroy_elements();
+                }
+                ::operator delete(control_, std::align_val_t{ base_page_size() });
+            }
+            unmap_mirror();
+        }
+        delete[] occupied_;
+        occupied_ = nullptr;
+        data_ = nullptr;
+        control_ = nullptr;
+    }
+
+    static std::size_t base_page_size() noexcept {
+#if defined(__linux__)
+        return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#else
+        return 4096;
+#endif
+    }
+
+    // Default huge page size, the PMD size on Linux
+    static std::size_t huge_page_size() noexcept {
+        std::size_t size = 2u << 20;
+#if defined(__linux__)
+        int fd = ::open("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            char buffer[32] = {};
+            if (::read(fd, buffer, sizeof(buffer) - 1) > 0) {
+                auto value = std::strtoull(buffer, nullptr, 10);
+                if (value != 0) {
+                    size = static_cast<std::size_t>(value);
+                }
+            }
+            ::close(fd);
+        }
+#endif
+        return size;
+    }
+
+#if defined(__linux__)
+    void advise_huge_pages(void* memory, std::size_t bytes) noexcept {
+        if (::madvise(memory, bytes, MADV_HUGEPAGE) == 0) {
+            backing_ = page_backing::transparent_huge;
+        }
+    }
+
+    // Map anonymous memory for the arrays of a local queue, from the hugetlb pool when it
+    // has pages and advised for transparent huge pages otherwise
+    uint8_t* map_anonymous(std::size_t bytes) {
+        const std::size_t huge = huge_page_size();
+        mapped_bytes_ = align_up(bytes, huge_pages_ ? huge : base_page_size());
+        void* memory = MAP_FAILED;
+        if (huge_pages_) {
+            memory = ::mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+        if (memory != MAP_FAILED) {
+            backing_ = page_backing::huge;
+            backing_page_size_ = huge;
+        } else {
+            memory = ::mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) {
+                throw std::runtime_error(std::string("Failed to map queue arrays: ") + std::strerror(errno));
+            }
+            if (huge_pages_) {
+                advise_huge_pages(memory, mapped_bytes_);
+            }
+        }
+        mapped_ = static_cast<uint8_t*>(memory);
+        return mapped_;
+    }
+
+    static constexpr uint32_t HUGETLBFS_MAGIC = 0x958458f6;
+
+    std::string huge_segment_path() const {
+        return std::string(SLICK_QUEUE_HUGETLBFS_DIR) + "/" + (shm_name_[0] == '/' ? shm_name_.substr(1) : shm_name_);
+    }
+
+    // True if the segment has a file on hugetlbfs, which attachers map in preference to slick-shm
+    bool huge_segment_exists() const {
+        struct statfs fs {};
+        return ::statfs(huge_segment_path().c_str(), &fs) == 0 && static_cast<uint32_t>(fs.f_type) == HUGETLBFS_MAGIC;
+    }
+
+    // A creator sizes its hugetlbfs file right after creating it, wait for that the way
+    // wait_for_shared_memory_ready() waits for the header. Returns false if the file stays empty
+    // or was unlinked because its creator fell back to slick-shm.
+    static bool wait_for_huge_segment_size(int fd, struct stat& st) noexcept {
+        constexpr int kMaxWaitMs = 2000;
+        for (int i = 0;; ++i) {
+            if (::fstat(fd, &st) != 0 || st.st_nlink == 0) {
+                return false;
+            }
+            if (st.st_size != 0) {
+                return true;
+            }
+            if (i >= kMaxWaitMs) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Map the segment from a file on hugetlbfs. Returns false if there is no such file, if an
+    // existing one is never sized or, when creating, if hugetlbfs or its page pool cannot hold
+    // the segment.
+    bool map_huge_segment(bool create) noexcept {
+        std::string path = huge_segment_path();
+        int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0666);
+        if (fd < 0) {
+            // lost the race to another creator, share its segment once it is sized
+            return create && errno == EEXIST && map_huge_segment(false);
+        }
+        struct statfs fs {};
+        struct stat st {};
+        bool usable = ::fstatfs(fd, &fs) == 0 && static_cast<uint32_t>(fs.f_type) == HUGETLBFS_MAGIC &&
+            ::fstat(fd, &st) == 0;
+        const std::size_t huge = usable ? static_cast<std::size_t>(fs.f_bsize) : 0;
+        std::size_t bytes = 0;
+        if (usable && create) {
+            backing_page_size_ = huge;  // the mirrored data array is aligned to it
+            bytes = align_up(segment_size(), huge);
+            usable = (!mirrored_ || (sizeof(T) * size_) % huge == 0) && ::ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+        } else if (usable) {
+            usable = wait_for_huge_segment_size(fd, st);
+            bytes = static_cast<std::size_t>(st.st_size);
+        }
+        void* memory = usable ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            if (create) {
+                ::unlink(path.c_str());
+            }
+            backing_page_size_ = base_page_size();
+            return false;
+        }
+        mapped_ = static_cast<uint8_t*>(memory);
+        mapped_bytes_ = bytes;
+        huge_path_ = std::move(path);
+        backing_ = page_backing::huge;
+        backing_page_size_ = huge;
+        lpvMem_ = mapped_;
+        return true;
+    }
+#endif
+
+    std::size_t segment_mapped_bytes() const noexcept {
+        return mapped_ ? mapped_bytes_ : shm_.size();
+    }
+
+    // Invoke fn(memory, bytes) for every memory region of the queue: the whole segment for
+    // shared memory, the arrays for local queues. With mirror the second view of a mirrored
+    // ring is visited as well. Stops and returns false as soon as fn does.
+    template<typename Fn>
+    bool for_each_region(Fn&& fn, bool mirror) const {
+        const std::size_t data_bytes = sizeof(T) * size_;
+        if (use_shm_) {
+            if (!fn(static_cast<uint8_t*>(lpvMem_), segment_mapped_bytes())) {
+                return false;
+            }
+            return !(mirror && mirrored_) || fn(data_, 2 * data_bytes);
+        }
+        if (mapped_) {
+            return fn(mapped_, mapped_bytes_);
+        }
+        if (block_) {
+            return fn(block_, block_bytes_);
+        }
+        if (!fn(control_, control_stride_ * size_) || !fn(data_, data_bytes)) {
+            return false;
+        }
+        return !(mirror && mirrored_) || fn(data_ + data_bytes, data_bytes);
+    }
+
+    // Fault in the pages of [memory, memory + bytes) without changing their contents
+    static void prefault(uint8_t* memory, std::size_t bytes) noexcept {
+        if (bytes == 0) {
+            return;
+        }
+        const std::size_t page = base_page_size();
+        const auto first = reinterpret_cast<std::uintptr_t>(memory);
+        const auto end = first + bytes;
+        const auto begin = first & ~static_cast<std::uintptr_t>(page - 1);
+#if defined(__linux__)
+#if defined(MADV_POPULATE_WRITE)
+        constexpr int madv_populate_write = MADV_POPULATE_WRITE;
+#else
+        constexpr int madv_populate_write = 23;  // Linux 5.14 ABI value, for older kernel headers
+#endif
+        if (::madvise(reinterpret_cast<void*>(begin), end - begin, madv_populate_write) == 0) {
+            return;
+        }
+#endif
+        // older kernels: a write fault per page, the atomic add of 0 leaves live data intact.
+        // Pages are stepped by address, touching the first byte of each that lies in the region.
+        for (auto address = begin; address < end; address += page) {
+            auto* byte = reinterpret_cast<uint8_t*>(address < first ? first : address);
+            std::atomic_ref<uint8_t>(*byte).fetch_add(0, std::memory_order_relaxed);
+        }
+    }
+
+    void warm_up_memory(const warm_up_options& options) {
+        if (!options.prefault && !options.lock) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (options.prefault) {
+            const uint32_t threads = options.threads == 0 ? 1 : options.threads;
+            const std::size_t page = base_page_size();
+            for_each_region([&](uint8_t* memory, std::size_t bytes) {
+                std::size_t share = align_up((bytes + threads - 1) / threads, page);
+                std::vector<std::thread> helpers;
+                for (std::size_t offset = share; offset < bytes; offset += share) {
+                    helpers.emplace_back([=]() { prefault(memory + offset, bytes - offset < share ? bytes - offset : share); });
+                }
+                prefault(memory, bytes < share ? bytes : share);
+                for (auto& helper : helpers) {
+                    helper.join();
+                }
+                return true;
+            }, true);
+        }
+        if (options.lock) {
+#if defined(__linux__)
+            locked_ = for_each_region([](uint8_t* memory, std::size_t bytes) {
+                return ::mlock(memory, bytes) == 0;
+            }, true);
+            if (!locked_) {
+                // do not leave part of the memory pinned, heap pages stay locked after delete
+                for_each_region([](uint8_t* memory, std::size_t bytes) {
+                    ::munlock(memory, bytes);
+                    return true;
+                }, true);
+            }
+#endif
+        }
+        warm_up_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    }
+
+    static constexpr std::size_t kNumaMaskBits = 1024;
+    using numa_mask = unsigned long[kNumaMaskBits / (8 * sizeof(unsigned long))];
+
+    // Parse a node list such as "0-1,3" from sysfs into mask
+    static bool read_node_list(const char* path, numa_mask& mask) noexcept {
+#if defined(__linux__)
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        char buffer[256] = {};
+        auto length = ::read(fd, buffer, sizeof(buffer) - 1);
+        ::close(fd);
+        if (length <= 0) {
+            return false;
+        }
+        constexpr std::size_t word_bits = 8 * sizeof(unsigned long);
+        char* cursor = buffer;
+        while (*cursor >= '0' && *cursor <= '9') {
+            auto first = std::strtoul(cursor, &cursor, 10);
+            auto last = first;
+            if (*cursor == '-') {
+                last = std::strtoul(cursor + 1, &cursor, 10);
+            }
+            for (auto node = first; node <= last && node < kNumaMaskBits; ++node) {
+                mask[node / word_bits] |= 1ul << (node % word_bits);
+            }
+            if (*cursor == ',') {
+                ++cursor;
+            }
+        }
+        return true;
+#else
+        (void)path;
+        (void)mask;
+        return false;
+#endif
+    }
+
+    void set_numa_policy(numa_policy policy, uint32_t node) {
+        if (policy > numa_policy::interleave) {
+            throw std::invalid_argument("unknown NUMA policy " + std::to_string(static_cast<uint32_t>(policy)));
+        }
+#if defined(__linux__)
+        if (policy == numa_policy::preferred || policy == numa_policy::bind) {
+            numa_mask nodes = {};
+            if (!read_node_list("/sys/devices/system/node/has_memory", nodes)) {
+                nodes[0] = 1;  // kernel without NUMA support, a single node 0
+            }
+            constexpr std::size_t word_bits = 8 * sizeof(unsigned long);
+            if (node >= kNumaMaskBits || (nodes[node / word_bits] & (1ul << (node % word_bits))) == 0) {
+                throw std::invalid_argument("NUMA node " + std::to_string(node) + " has no memory");
+            }
+        }
+        numa_ = policy;
+        numa_node_ = node;
+#else
+        (void)node;
+#endif
+    }
+
+    // Apply the NUMA policy to whole pages before they are first touched; pages touched
+    // already are migrated. Best effort, numa_placement() reports the outcome.
+    void apply_numa(void* memory, std::size_t bytes) const noexcept {
+#if defined(__linux__)
+        if (numa_ == numa_policy::none || memory == nullptr || bytes == 0) {
+            return;
+        }
+        constexpr std::size_t word_bits = 8 * sizeof(unsigned long);
+        numa_mask nodes = {};
+        int mode = MPOL_PREFERRED;
+        if (numa_ == numa_policy::interleave) {
+            mode = MPOL_INTERLEAVE;
+            if (!read_node_list("/sys/devices/system/node/has_memory", nodes)) {
+                nodes[0] = 1;
+            }
+        } else {
+            mode = numa_ == numa_policy::bind ? MPOL_BIND : MPOL_PREFERRED;
+            nodes[numa_node_ / word_bits] = 1ul << (numa_node_ % word_bits);
+        }
+        ::syscall(SYS_mbind, memory, bytes, mode, nodes, kNumaMaskBits + 1, MPOL_MF_MOVE);
+#else
+        (void)memory;
+        (void)bytes;
+#endif
+    }
+
+    // Map the segment. Attachers and creators asking for huge pages prefer an existing hugetlbfs
+    // file; such a creator places a new segment on hugetlbfs and otherwise falls back to
+    // slick-shm with transparent huge pages. Other creators only use slick-shm.
+    void map_segment(bool create) {
+#if defined(__linux__)
+        if ((!create || huge_pages_) && map_huge_segment(false)) {
+            return;
+        }
+        if (create && huge_pages_) {
+            // an existing regular segment is shared as it is
+            try {
+                shm_ = slick::shm::shared_memory(shm_name_.c_str(), slick::shm::open_existing,
+                    slick::shm::access_mode::read_write);
+                lpvMem_ = shm_.data();
+                return;
+            } catch (const slick::shm::shared_memory_error&) {
+            }
+            if (map_huge_segment(true)) {
+                return;
+            }
+        }
+#endif
+        try {
+            if (create) {
+                shm_ = slick::shm::shared_memory(
+                    shm_name_.c_str(),
+                    segment_size(),
+                    slick::shm::open_or_create,
+                    slick::shm::access_mode::read_write
+                );
+            } else {
+                shm_ = slick::shm::shared_memory(
+                    shm_name_.c_str(),
+                    slick::shm::open_existing,
+                    slick::shm::access_mode::read_write
+                );
+            }
+        } catch (const slick::shm::shared_memory_error& e) {
+            throw std::runtime_error(std::string(create ? "Failed to create/open shared memory: " :
+                "Failed to open shared memory: ") + e.what());
+        }
+        lpvMem_ = shm_.data();
+#if defined(__linux__)
+        if (create && huge_pages_ && lpvMem_) {
+            advise_huge_pages(lpvMem_, shm_.size());
+        }
+#endif
+    }
+
+    // Attachers follow the creator: a hugetlbfs segment is already mapped as such, transparent
+    // huge page advice is repeated on this process' mapping
+    void apply_page_backing(uint8_t* base) noexcept {
+        if (backing_ == page_backing::huge || header_size_ != HEADER_SIZE_V2) {
+            return;
+        }
+        backing_ = page_backing::base;
+        auto backing = *reinterpret_cast<uint32_t*>(base + PAGE_BACKING_OFFSET);
+        if (backing == static_cast<uint32_t>(page_backing::transparent_huge)) {
+#if defined(__linux__)
+            advise_huge_pages(lpvMem_, shm_.size());
+#endif
+        }
+    }
+
+    void validate_mirror() const {
+#if defined(__linux__)
+        if (layout_ != queue_layout::separate) {
+            throw std::invalid_argument("mirrored queue requires the separate layout");
+        }
+        if ((sizeof(T) * size_) % base_page_size() != 0) {
+            throw std::invalid_argument("mirrored queue requires size() * sizeof(T) to be a multiple of the page size " +
+                std::to_string(base_page_size()));
+        }
+#else
+        throw std::runtime_error("mirrored queue is only supported on Linux");
+#endif
+    }
+
+    // Map bytes of fd at offset twice back to back and point data_ at the first copy, which
+    // starts on a page_align boundary
+    void map_mirror(int fd, std::size_t offset, std::size_t page_align) {
+#if defined(__linux__)
+        const std::size_t bytes = sizeof(T) * size_;
+        // reserve the address range first so both copies are guaranteed to be adjacent
+        const std::size_t span = 2 * bytes + page_align;
+        void* region = ::mmap(nullptr, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (region == MAP_FAILED) {
+            throw std::runtime_error(std::string("Failed to reserve mirrored ring: ") + std::strerror(errno));
+        }
+        auto* start = static_cast<uint8_t*>(region);
+        auto* base = reinterpret_cast<uint8_t*>(align_up(reinterpret_cast<std::size_t>(start), page_align));
+        // trim the slack so that unmap_mirror() releases the whole reservation
+        if (base != start) {
+            ::munmap(start, static_cast<std::size_t>(base - start));
+        }
+        if (start + span != base + 2 * bytes) {
+            ::munmap(base + 2 * bytes, static_cast<std::size_t>(start + span - (base + 2 * bytes)));
+        }
+        for (int copy = 0; copy < 2; ++copy) {
+            if (::mmap(base + copy * bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                    static_cast<off_t>(offset)) == MAP_FAILED) {
+                int err = errno;
+                ::munmap(base, 2 * bytes);
+                throw std::runtime_error(std::string("Failed to map mirrored ring: ") + std::strerror(err));
+            }
+        }
+        data_ = base;
+#else
+        (void)fd;
+        (void)offset;
+        (void)page_align;
+#endif
+    }
+
+    void map_local_mirror() {
+#if defined(__linux__)
+        const std::size_t huge = huge_page_size();
+        if (huge_pages_ && (sizeof(T) * size_) % huge == 0) {
+            int fd = ::memfd_create("slick_queue", MFD_CLOEXEC | MFD_HUGETLB);
+            if (fd >= 0) {
+                try {
+                    if (::ftruncate(fd, static_cast<off_t>(sizeof(T) * size_)) == 0) {
+                        map_mirror(fd, 0, huge);
+                        backing_ = page_backing::huge;
+                        backing_page_size_ = huge;
+                    }
+                } catch (const std::runtime_error&) {
+                    // the hugetlb pool is exhausted, fall back to base pages
+                }
+                ::close(fd);
+                if (backing_ == page_backing::huge) {
+                    return;
+                }
+            }
+        }
+        int fd = ::memfd_create("slick_queue", MFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("Failed to create mirrored ring: ") + std::strerror(errno));
+        }
+        if (::ftruncate(fd, static_cast<off_t>(sizeof(T) * size_)) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error(std::string("Failed to size mirrored ring: ") + std::strerror(err));
+        }
+        try {
+            map_mirror(fd, 0, base_page_size());
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);  // the mappings keep the memory alive
+        if (huge_pages_) {
+            advise_huge_pages(data_, 2 * sizeof(T) * size_);
+        }
+#endif
+    }
+
+#if defined(__linux__)
+    // Open the file backing the mapping that contains address. The path comes from
+    // /proc/self/maps and the file must still have the device and inode listed there, so a
+    // segment unlinked and recreated under the same name is refused instead of mapped.
+    static int open_mapped_file(const void* address) {
+        FILE* maps = std::fopen("/proc/self/maps", "re");
+        if (!maps) {
+            throw std::runtime_error(std::string("Failed to read /proc/self/maps: ") + std::strerror(errno));
+        }
+        const auto target = reinterpret_cast<unsigned long>(address);
+        char* line = nullptr;
+        std::size_t capacity = 0;
+        int fd = -1;
+        bool found = false;
+        while (!found && ::getline(&line, &capacity, maps) > 0) {
+            unsigned long start = 0, end = 0, inode = 0;
+            unsigned int major_id = 0, minor_id = 0;
+            int path = 0;
+            if (std::sscanf(line, "%lx-%lx %*s %*x %x:%x %lu %n", &start, &end, &major_id, &minor_id, &inode, &path) < 5 ||
+                target < start || target >= end) {
+                continue;
+            }
+            found = true;
+            line[std::strcspn(line, "\n")] = '\0';
+            fd = path > 0 && line[path] == '/' ? ::open(line + path, O_RDWR | O_CLOEXEC) : -1;
+            struct stat st {};
+            if (fd >= 0 && (::fstat(fd, &st) != 0 || major(st.st_dev) != major_id || minor(st.st_dev) != minor_id ||
+                    st.st_ino != inode)) {
+                ::close(fd);
+                fd = -1;
             }
         }
+        std::free(line);
+        std::fclose(maps);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open mirrored ring: the shared memory segment was removed or replaced");
+        }
+        return fd;
     }
+#endif
 
-    /**
-     * @brief Read data from the queue
-     * @param read_index Reference to the reading index, will be updated to the next index after reading
-     * @return Pair of pointer to the data and the size of the data, or nullptr and 0 if no data is available
-     */
-    std::pair<T*, uint32_t> read(uint64_t& read_index) noexcept {
-        uint64_t index;
-        slot* current_slot;
-        while (true) {
-            auto idx = read_index & mask_;
-            current_slot = &control_[idx];
-            index = current_slot->data_index.load(std::memory_order_acquire);
-            if (index != std::numeric_limits<uint64_t>::max() && get_index(reserved_->load(std::memory_order_relaxed)) < index) [[unlikely]] {
-                // queue has been reset
-                read_index = 0;
-            }
+    // The segment is mapped once as a whole; map its data array twice more from the same file
+    void map_shm_mirror() {
+#if defined(__linux__)
+        int fd = open_mapped_file(lpvMem_);
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < mirrored_data_offset() + sizeof(T) * size_) {
+            ::close(fd);
+            throw std::runtime_error("Failed to open mirrored ring: the shared memory segment is too small");
+        }
+        try {
+            map_mirror(fd, mirrored_data_offset(), backing_page_size_);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+#endif
+    }
 
-#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
-            if (index != std::numeric_limits<uint64_t>::max() && index > read_index && ((index & mask_) == idx)) {
-                loss_count_.fetch_add(index - read_index, std::memory_order_relaxed);
-            }
+    void unmap_mirror() noexcept {
+#if defined(__linux__)
+        if (mirrored_ && data_) {
+            ::munmap(data_, 2 * sizeof(T) * size_);
+            data_ = nullptr;
+        }
 #endif
+    }
 
-            if (index == std::numeric_limits<uint64_t>::max() || index < read_index) {
-                // data not ready yet
-                return std::make_pair(nullptr, 0);
-            }
-            else if (index > read_index && ((index & mask_) != idx)) {
-                // queue wrapped, skip the unused slots
-                read_index = index;
-                continue;
-            }
-            break;
+    // Helper functions for packing/unpacking reserved_info (16-bit size, 48-bit index)
+    static constexpr uint64_t make_reserved_info(uint64_t index, uint32_t size) noexcept {
+        return ((index & 0xFFFFFFFFFFFFULL) << 16) | (size & 0xFFFF);
+    }
+
+    static constexpr uint64_t get_index(uint64_t reserved) noexcept {
+        return reserved >> 16;
+    }
+
+    static constexpr uint32_t get_size(uint64_t reserved) noexcept {
+        return static_cast<uint32_t>(reserved & 0xFFFF);
+    }
+
+    // Only called when the slot under a cursor is not ready. A cursor past the reservation
+    // cursor can only happen after reset(), and only for a cursor that was advanced before
+    // it, so at most up to the reset limit. The producer-hot reserved_ line is loaded only
+    // for such a cursor, and only when the cursor is past the reservation index this
+    // instance last saw in the current epoch, since reserved_ only grows between resets.
+    // Repeated empty polls of a caught-up consumer therefore never touch it, and once
+    // production passes the reset limit no poll does.
+    bool was_reset(uint64_t read_index) const noexcept {
+        auto epoch = reset_epoch_->load(std::memory_order_acquire);
+        if (epoch == 0 || read_index > reset_limit_->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        auto seen = reset_seen_.load(std::memory_order_relaxed);
+        if ((seen & 0xFFFF) == (epoch & 0xFFFF) && read_index <= get_index(seen)) {
+            return false;
         }
+        auto reserved = get_index(reserved_->load(std::memory_order_relaxed));
+        reset_seen_.store(make_reserved_info(reserved, static_cast<uint32_t>(epoch & 0xFFFF)), std::memory_order_relaxed);
+        return reserved < read_index;
+    }
+
 
-        auto& data = data_[read_index & mask_];
-        read_index = index + current_slot->size;
-        return std::make_pair(&data, current_slot->size);
+    // Spin briefly, then yield so a waiting producer does not starve the consumer it waits on
+    static inline void backoff(uint32_t spins) noexcept {
+        if (spins < 64) {
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
     }
 
-    /**
-     * @brief Read data from the queue using a shared atomic cursor
-     * @param read_index Reference to the atomic reading index, will be atomically updated after reading
-     * @return Pair of pointer to the data and the size of the data, or nullptr and 0 if no data is available
-     *
-     * This overload allows multiple consumers to share a single atomic cursor for load-balancing/work-stealing patterns.
-     * Each consumer atomically claims the next item to process.
-     */
-    std::pair<T*, uint32_t> read(std::atomic<uint64_t>& read_index) noexcept {
-        while (true) {
-            uint64_t current_index = read_index.load(std::memory_order_relaxed);
-            auto idx = current_index & mask_;
-            slot* current_slot = &control_[idx];
-            uint64_t index = current_slot->data_index.load(std::memory_order_acquire);
+    template<typename Rep, typename Period>
+    static std::chrono::steady_clock::time_point deadline_after(std::chrono::duration<Rep, Period> timeout) noexcept {
+        auto now = std::chrono::steady_clock::now();
+        // compare in the unit of timeout, converting a long timeout to nanoseconds would overflow
+        auto limit = std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(std::chrono::steady_clock::time_point::max() - now);
+        if (timeout >= limit) {
+            return std::chrono::steady_clock::time_point::max();
+        }
+        return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+    }
 
-            if (index != std::numeric_limits<uint64_t>::max() && get_index(reserved_->load(std::memory_order_relaxed)) < index) [[unlikely]] {
-                // queue has been reset
-                read_index.store(0, std::memory_order_relaxed);
+    // Number of entries, up to n, that read() would return from read_index without waiting
+    uint32_t ready_entries(uint64_t read_index, uint32_t n) const noexcept {
+        uint32_t count = 0;
+        while (count < n) {
+            auto idx = read_index & ring_mask();
+            uint32_t size;
+            auto index = load_slot(idx, size);
+            if (index == kInvalidIndex || index < read_index) {
+                // a cursor stranded by reset() is reported ready so the next read() rewinds it
+                return was_reset(read_index) ? n : count;
+            }
+            if (index > read_index && (index & ring_mask()) != idx) {
+                // wrap marker
+                read_index = index;
                 continue;
             }
+            read_index = index + size;
+            ++count;
+        }
+        return count;
+    }
 
-            if (index == std::numeric_limits<uint64_t>::max() || index < current_index) {
-                // data not ready yet
-                return std::make_pair(nullptr, 0);
-            }
+    void use_local_wait_state(bool futex) noexcept {
+        wait_seq_ = &wait_seq_local_;
+        sleepers_ = &sleepers_local_;
+        notify_armed_ = &notify_armed_local_;
+        shared_wait_state_ = futex;
+    }
 
-#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
-            uint64_t overrun = 0;
-            if (index > current_index && ((index & mask_) == idx)) {
-                overrun = index - current_index;
+    // Spins and sleeps with the Wait strategy until ready() returns true or the deadline passes.
+    template<typename Wait, typename Ready>
+    bool wait_until(Ready&& ready, std::chrono::steady_clock::time_point deadline) noexcept {
+        for (uint32_t spins = 0;; ++spins) {
+            if (ready()) {
+                return true;
             }
-#endif
-
-            if (index > current_index && ((index & mask_) != idx)) {
-                // queue wrapped, skip the unused slots
-                read_index.compare_exchange_weak(current_index, index, std::memory_order_relaxed, std::memory_order_relaxed);
-                continue;
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
             }
-
-            // Try to atomically claim this item
-            uint64_t next_index = index + current_slot->size;
-            if (read_index.compare_exchange_weak(current_index, next_index, std::memory_order_relaxed, std::memory_order_relaxed)) {
-#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
-                if (overrun != 0) {
-                    loss_count_.fetch_add(overrun, std::memory_order_relaxed);
+            if constexpr (std::is_same_v<Wait, blocking_wait>) {
+                if (spins < blocking_wait::spin_limit) {
+                    cpu_relax();
+                } else if (!shared_wait_state_) {
+                    sleep_wait::idle(spins);
+                } else if (sleep_until_published(ready, deadline - now)) {
+                    return true;
                 }
-#endif
-                // Successfully claimed the item
-                return std::make_pair(&data_[current_index & mask_], current_slot->size);
+            } else {
+                Wait::idle(spins);
             }
-            cpu_relax();
-            // CAS failed, another consumer claimed it, retry
         }
     }
 
-    /**
-    * @brief Read the last published data in the queue
-    * @return Pointer to the last published data, or nullptr if no data is available
-    */
-    std::pair<T*, uint32_t> read_last() noexcept {
-        if (last_published_valid_) {
-            auto last_index = last_published_->load(std::memory_order_acquire);
-            if (last_index == kInvalidIndex) {
-                return std::make_pair(nullptr, 0);
+    // Announce the sleeper before the last readiness check, pairing with light_fence() in
+    // notify_published(): either the producer sees the sleeper or this check sees its publish.
+    template<typename Ready>
+    bool sleep_until_published(Ready& ready, std::chrono::steady_clock::duration remaining) noexcept {
+        sleepers_->fetch_add(1, std::memory_order_relaxed);
+        heavy_fence();
+        auto seq = wait_seq_->load(std::memory_order_acquire);
+        bool ready_now = ready();
+        if (!ready_now) {
+            futex_sleep(seq, remaining);
+        }
+        sleepers_->fetch_sub(1, std::memory_order_release);
+        return ready_now;
+    }
+
+    void update_last_published(uint64_t index) noexcept {
+        if constexpr (single_producer_) {
+            if (last_published_valid_ &&
+                (producer_last_published_ == kInvalidIndex || producer_last_published_ < index)) {
+                producer_last_published_ = index;
+                last_published_->store(index, std::memory_order_release);
+            }
+        }
+        else if (last_published_valid_) {
+            auto current = last_published_->load(std::memory_order_relaxed);
+            while ((current == kInvalidIndex || current < index) &&
+                   !last_published_->compare_exchange_weak(
+                       current, index, std::memory_order_release, std::memory_order_relaxed)) {
             }
-            slot &slot = control_[last_index];
-            return std::make_pair(&data_[last_index & mask_], slot.size);
         }
+    }
 
-        // legacy
-        auto reserved = reserved_->load(std::memory_order_relaxed);
-        auto index = get_index(reserved);
-        if (index == 0) {
-            return std::make_pair(nullptr, 0);
+    // Plain loads of words that only change while consumers wait, so spinning consumers cost
+    // publish() nothing but the compiler barrier
+    void notify_published() noexcept {
+        light_fence();
+        if ((sleepers_->load(std::memory_order_relaxed) | notify_armed_->load(std::memory_order_relaxed)) != 0) [[unlikely]] {
+            wake_waiters();
+        }
+        if (awaiter_count_.load(std::memory_order_relaxed) != 0) [[unlikely]] {
+            resume_awaiters(true);
         }
-        auto sz = get_size(reserved);
-        auto last_index = index - sz;
-        return std::make_pair(&data_[last_index & mask_], sz);
     }
 
-    /**
-     * @brief Reset the queue, invalidating all existing data
-     * 
-     * Note: This function is not thread-safe and should be called when no other threads are accessing the queue.
-     */
-    void reset() noexcept {
-        if (use_shm_) {
-            control_ = new ((uint8_t*)lpvMem_ + HEADER_SIZE) slot[size_];
+    void wake_waiters() noexcept {
+        if (sleepers_->load(std::memory_order_relaxed) != 0) {
+            wait_seq_->fetch_add(1, std::memory_order_release);
+            futex_wake();
+        }
+        if (notify_armed_->load(std::memory_order_relaxed) != 0 &&
+            notify_armed_->exchange(0, std::memory_order_acquire) != 0) {
+            signal_notifier();
+        }
+    }
+
+    // Asymmetric fence between publish() and consumers about to wait. A waiter announces itself
+    // and calls heavy_fence() before its last readiness check; publish() only puts light_fence()
+    // between its release store and the plain loads of the waiter words. heavy_fence() runs a
+    // full barrier on every thread that may be publishing (membarrier, FlushProcessWriteBuffers),
+    // so either the producer sees the waiter or the waiter sees the entry. Shared memory queues
+    // reach the producers of every process attached to the segment, each of which registered
+    // here when it mapped it. Where this is not available light_fence() is a full fence.
+    static bool asymmetric_fence_available(bool global = false) noexcept {
+#if defined(__linux__)
+        auto enable = [](int command, int registration) {
+            long commands = ::syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+            return commands > 0 && (commands & command) != 0 && ::syscall(SYS_membarrier, registration, 0, 0) == 0;
+        };
+        if (global) {
+            static const bool registered = enable(MEMBARRIER_CMD_GLOBAL_EXPEDITED, MEMBARRIER_CMD_REGISTER_GLOBAL_EXPEDITED);
+            return registered;
+        }
+        static const bool registered = enable(MEMBARRIER_CMD_PRIVATE_EXPEDITED, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED);
+        return registered;
+#elif defined(_WIN32)
+        // no futex sleepers or notifier here, only awaiters of this process need the fence
+        (void)global;
+        return true;
+#else
+        (void)global;
+        return false;
+#endif
+    }
+
+    void light_fence() const noexcept {
+        if (asymmetric_fence_) [[likely]] {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
         } else {
-            delete [] control_;
-            control_ = new slot[size_];
+            std::atomic_thread_fence(std::memory_order_seq_cst);
         }
-        reserved_->store(0, std::memory_order_release);
-        last_published_->store(kInvalidIndex, std::memory_order_relaxed);
-#if SLICK_QUEUE_ENABLE_LOSS_DETECTION
-        loss_count_.store(0, std::memory_order_relaxed);
+    }
+
+    void heavy_fence() const noexcept {
+        if (asymmetric_fence_) {
+#if defined(__linux__)
+            if (::syscall(SYS_membarrier, use_shm_ ? MEMBARRIER_CMD_GLOBAL_EXPEDITED : MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0) == 0) {
+                return;
+            }
+#elif defined(_WIN32)
+            ::FlushProcessWriteBuffers();
+            return;
 #endif
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
     }
 
-private:
-    // Helper functions for packing/unpacking reserved_info (16-bit size, 48-bit index)
-    static constexpr uint64_t make_reserved_info(uint64_t index, uint32_t size) noexcept {
-        return ((index & 0xFFFFFFFFFFFFULL) << 16) | (size & 0xFFFF);
+    template<typename Scheduler>
+    static void bind_scheduler(awaiter_node& node, Scheduler& scheduler) noexcept {
+        static_assert(noexcept(scheduler.schedule(std::coroutine_handle<>{})),
+            "Scheduler::schedule(std::coroutine_handle<>) must be noexcept, the noexcept publish() calls it");
+        node.scheduler = &scheduler;
+        node.schedule = [](void* s, std::coroutine_handle<> handle) {
+            static_cast<Scheduler*>(s)->schedule(handle);
+        };
     }
 
-    static constexpr uint64_t get_index(uint64_t reserved) noexcept {
-        return reserved >> 16;
+    void lock_awaiters() noexcept {
+        for (uint32_t spins = 0; awaiters_lock_.test_and_set(std::memory_order_acquire); ++spins) {
+            backoff(spins);
+        }
     }
 
-    static constexpr uint32_t get_size(uint64_t reserved) noexcept {
-        return static_cast<uint32_t>(reserved & 0xFFFF);
+    void unlock_awaiters() noexcept {
+        awaiters_lock_.clear(std::memory_order_release);
     }
 
-    static inline void cpu_relax() noexcept {
-#if SLICK_QUEUE_ENABLE_CPU_RELAX
-#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
-        _mm_pause();
-#elif defined(__i386__) || defined(__x86_64__)
-        __builtin_ia32_pause();
-#elif defined(__aarch64__) || defined(__arm__)
-        __asm__ __volatile__("yield" ::: "memory");
-#else
-        std::this_thread::yield();
+    // Returns false if data became ready while registering, the coroutine then continues.
+    // Once the node is linked a producer or resume_ready() may resume the coroutine at any
+    // time, so the node is not dereferenced again unless it is found and unlinked here first.
+    bool suspend_awaiter(awaiter_node* node) noexcept {
+        uint64_t read_index = node->read_index;
+        bool scheduled = node->schedule != nullptr;
+        lock_awaiters();
+        node->next = awaiters_;
+        awaiters_ = node;
+        if (scheduled) {
+            awaiter_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        unlock_awaiters();
+
+        if (scheduled) {
+            // pairs with light_fence() in notify_published()
+            heavy_fence();
+        }
+        if (ready_entries(read_index, 1) == 0) {
+            return true;
+        }
+
+        bool unlinked = false;
+        lock_awaiters();
+        for (auto** link = &awaiters_; *link; link = &(*link)->next) {
+            if (*link == node) {
+                *link = node->next;
+                if (scheduled) {
+                    awaiter_count_.fetch_sub(1, std::memory_order_relaxed);
+                }
+                unlinked = true;
+                break;
+            }
+        }
+        unlock_awaiters();
+        return !unlinked;
+    }
+
+    // publish() only hands scheduled awaiters over, consumer coroutines never run on a producer
+    uint32_t resume_awaiters(bool scheduled_only) noexcept {
+        awaiter_node* ready = nullptr;
+        lock_awaiters();
+        for (auto** link = &awaiters_; *link;) {
+            auto* node = *link;
+            if ((!scheduled_only || node->schedule) && ready_entries(node->read_index, 1) != 0) {
+                *link = node->next;
+                node->next = ready;
+                ready = node;
+                if (node->schedule) {
+                    awaiter_count_.fetch_sub(1, std::memory_order_relaxed);
+                }
+            } else {
+                link = &node->next;
+            }
+        }
+        unlock_awaiters();
+
+        uint32_t count = 0;
+        while (ready) {
+            // the node dies with the awaiter once the coroutine runs
+            auto* node = ready;
+            ready = node->next;
+            if (node->schedule) {
+                node->schedule(node->scheduler, node->handle);
+            } else {
+                node->handle.resume();
+            }
+            ++count;
+        }
+        return count;
+    }
+
+#if defined(__linux__)
+    // Abstract unix socket address of a shm queue notifier, derived from the segment name
+    bool notifier_address(sockaddr_un& addr, socklen_t& len) const noexcept {
+        constexpr char prefix[] = "slick_queue/";
+        auto name = shm_name_.c_str();
+        if (*name == '/') {
+            ++name;
+        }
+        auto name_len = std::strlen(name);
+        if (1 + sizeof(prefix) - 1 + name_len > sizeof(addr.sun_path)) {
+            return false;
+        }
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path + 1, prefix, sizeof(prefix) - 1);
+        std::memcpy(addr.sun_path + sizeof(prefix), name, name_len);
+        len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + sizeof(prefix) + name_len);
+        return true;
+    }
+#endif
+
+    // Errors are ignored: a full notifier already has a signal pending, and a shm notifier
+    // whose consumer went away has nobody left to wake.
+    void signal_notifier() noexcept {
+#if defined(__linux__)
+        if (!use_shm_) {
+            int fd = notify_fd_.load(std::memory_order_acquire);
+            if (fd >= 0) {
+                ::eventfd_write(fd, 1);
+            }
+            return;
+        }
+        int fd = notify_send_fd_.load(std::memory_order_acquire);
+        if (fd < 0) {
+            int created = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (created < 0) {
+                return;
+            }
+            if (notify_send_fd_.compare_exchange_strong(fd, created, std::memory_order_acq_rel)) {
+                fd = created;
+            } else {
+                ::close(created);
+            }
+        }
+        sockaddr_un addr;
+        socklen_t len;
+        if (notifier_address(addr, len)) {
+            char signal = 1;
+            ::sendto(fd, &signal, 1, MSG_DONTWAIT | MSG_NOSIGNAL, reinterpret_cast<sockaddr*>(&addr), len);
+        }
+#endif
+    }
+
+    void close_notifier() noexcept {
+#if defined(__linux__)
+        for (auto* fd : { &notify_fd_, &notify_send_fd_ }) {
+            int value = fd->exchange(-1);
+            if (value >= 0) {
+                ::close(value);
+            }
+        }
 #endif
+    }
+
+    void futex_sleep(uint32_t expected, std::chrono::steady_clock::duration timeout) noexcept {
+#if defined(__linux__)
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        timespec ts{ static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(wait_seq_), use_shm_ ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+            expected, &ts, nullptr, 0);
 #else
-        (void)0;
+        (void)expected;
+        std::this_thread::sleep_for(timeout < sleep_wait::interval ? timeout : std::chrono::steady_clock::duration(sleep_wait::interval));
 #endif
     }
 
+    void futex_wake() noexcept {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(wait_seq_), use_shm_ ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE,
+            std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+#endif
+    }
 
     bool wait_for_shared_memory_ready(uint8_t* base, std::atomic<uint32_t>* init_state) const noexcept {
         constexpr int kMaxWaitMs = 2000;
@@ -518,10 +3408,8 @@ private:
             }
 
             if (state == INIT_STATE_LEGACY && i >= kLegacyGraceMs) {
-                uint32_t size = *reinterpret_cast<uint32_t*>(
-                    base + sizeof(std::atomic<reserved_info>));
-                uint32_t element_size = *reinterpret_cast<uint32_t*>(
-                    base + sizeof(std::atomic<reserved_info>) + sizeof(uint32_t));
+                uint32_t size = *reinterpret_cast<uint32_t*>(base + SIZE_OFFSET);
+                uint32_t element_size = *reinterpret_cast<uint32_t*>(base + ELEMENT_SIZE_OFFSET);
                 if (size != 0 && element_size != 0) {
                     return true;
                 }
@@ -535,22 +3423,93 @@ private:
 
 
 
+    // Locate the header atomics of an initialized segment (v2, v1 or legacy)
+    void map_header(uint8_t* base) noexcept {
+        auto* init_state = reinterpret_cast<std::atomic<uint32_t>*>(base + INIT_STATE_OFFSET);
+        uint32_t magic = 0;
+        if (init_state->load(std::memory_order_acquire) == INIT_STATE_READY) {
+            auto* header_magic = reinterpret_cast<std::atomic<uint32_t>*>(base + HEADER_MAGIC_OFFSET);
+            magic = header_magic->load(std::memory_order_acquire);
+        }
+
+        if (magic == HEADER_MAGIC_V2) {
+            uint32_t flags = *reinterpret_cast<uint32_t*>(base + FLAGS_OFFSET);
+            header_size_ = HEADER_SIZE_V2;
+            reserved_ = reinterpret_cast<std::atomic<reserved_info>*>(base + RESERVED_OFFSET_V2);
+            last_published_ = reinterpret_cast<std::atomic<uint64_t>*>(base + LAST_PUBLISHED_OFFSET_V2);
+            reset_epoch_ = reinterpret_cast<std::atomic<uint64_t>*>(base + RESET_EPOCH_OFFSET_V2);
+            reset_limit_ = reinterpret_cast<std::atomic<uint64_t>*>(base + RESET_LIMIT_OFFSET_V2);
+            wait_seq_ = reinterpret_cast<std::atomic<uint32_t>*>(base + WAIT_SEQ_OFFSET_V2);
+            sleepers_ = reinterpret_cast<std::atomic<uint32_t>*>(base + SLEEPERS_OFFSET_V2);
+            notify_armed_ = reinterpret_cast<std::atomic<uint32_t>*>(base + NOTIFY_ARMED_OFFSET_V2);
+            shared_wait_state_ = true;
+            scan_last_published_ = (flags & HEADER_FLAG_UNTRACKED_LAST_PUBLISHED) != 0;
+            last_published_valid_ = !scan_last_published_;
+            backpressure_ = (flags & HEADER_FLAG_BACKPRESSURE) != 0;
+            max_consumers_ = backpressure_ ? *reinterpret_cast<uint32_t*>(base + MAX_CONSUMERS_OFFSET) : 0;
+            consumer_count_ = reinterpret_cast<std::atomic<uint32_t>*>(base + CONSUMER_COUNT_OFFSET_V2);
+            gating_ = backpressure_ ? base + header_size_ : nullptr;
+            mirrored_ = (flags & HEADER_FLAG_MIRRORED) != 0;
+            uninitialized_ = (flags & HEADER_FLAG_UNINITIALIZED) != 0;
+        } else {
+            header_size_ = HEADER_SIZE;
+            reserved_ = reinterpret_cast<std::atomic<reserved_info>*>(base);
+            last_published_ = reinterpret_cast<std::atomic<uint64_t>*>(base + LAST_PUBLISHED_OFFSET);
+            // reset epoch and limit live in header bytes v1 leaves unused; resets by v1.4
+            // processes do not bump them
+            reset_epoch_ = reinterpret_cast<std::atomic<uint64_t>*>(base + RESET_EPOCH_OFFSET_V1);
+            reset_limit_ = reinterpret_cast<std::atomic<uint64_t>*>(base + RESET_LIMIT_OFFSET_V1);
+            // no shared wait state either, blocking_wait falls back to sleeping
+            use_local_wait_state(false);
+            scan_last_published_ = false;
+            last_published_valid_ = (magic == HEADER_MAGIC);
+            backpressure_ = false;
+            max_consumers_ = 0;
+            consumer_count_ = &consumer_count_local_;
+            gating_ = nullptr;
+            mirrored_ = false;
+            uninitialized_ = false;
+        }
+    }
+
+    // Size and element size of a segment whose header was mapped by map_header()
+    void read_geometry(const uint8_t* base, uint32_t& size, uint32_t& element_size) const noexcept {
+        bool v2 = header_size_ == HEADER_SIZE_V2;
+        size = *reinterpret_cast<const uint32_t*>(base + (v2 ? SIZE_OFFSET_V2 : SIZE_OFFSET));
+        element_size = *reinterpret_cast<const uint32_t*>(base + (v2 ? ELEMENT_SIZE_OFFSET_V2 : ELEMENT_SIZE_OFFSET));
+    }
+
+    // Layout and slot mapping of a mapped segment. Only v2 headers record them, so that
+    // readers that do not know the layout reject the segment (see read_geometry()); v1 and
+    // legacy segments are always separate and linear.
+    void read_layout(const uint8_t* base, uint32_t& layout, uint32_t& mapping) const noexcept {
+        if (header_size_ != HEADER_SIZE_V2) {
+            layout = static_cast<uint32_t>(queue_layout::separate);
+            mapping = static_cast<uint32_t>(slot_mapping::linear);
+            return;
+        }
+        layout = *reinterpret_cast<const uint32_t*>(base + LAYOUT_OFFSET);
+        mapping = *reinterpret_cast<const uint32_t*>(base + SLOT_MAPPING_OFFSET);
+    }
+
+    // The slot encoding is part of the type, a segment of the other encoding cannot be used
+    void check_compact_slots(const uint8_t* base) const {
+        bool compact = header_size_ == HEADER_SIZE_V2 &&
+            (*reinterpret_cast<const uint32_t*>(base + FLAGS_OFFSET) & HEADER_FLAG_COMPACT_SLOTS) != 0;
+        if (compact != compact_slots_) {
+            throw std::runtime_error(compact_slots_ ?
+                "Shared memory compact slot mismatch. Expected a segment of a compact_slots queue" :
+                "Shared memory compact slot mismatch. Segment was created with the compact_slots policy");
+        }
+    }
+
     void allocate_shm_data(const char* const shm_name, bool open_only) {
         shm_name_ = shm_name;  // Store for destructor cleanup
+        asymmetric_fence_ = asymmetric_fence_available(true);
 
         if (open_only) {
             // Opener constructor - open existing only
-            try {
-                shm_ = slick::shm::shared_memory(
-                    shm_name,
-                    slick::shm::open_existing,
-                    slick::shm::access_mode::read_write
-                );
-            } catch (const slick::shm::shared_memory_error& e) {
-                throw std::runtime_error(std::string("Failed to open shared memory: ") + e.what());
-            }
-
-            lpvMem_ = shm_.data();
+            map_segment(false);
             if (!lpvMem_) {
                 throw std::runtime_error("Failed to map shared memory");
             }
@@ -561,53 +3520,54 @@ private:
                 throw std::runtime_error("Timed out waiting for shared memory initialization");
             }
 
-            uint32_t state = init_state->load(std::memory_order_acquire);
-            last_published_valid_ = false;
-            if (state == INIT_STATE_READY) {
-                auto* header_magic = reinterpret_cast<std::atomic<uint32_t>*>(base + HEADER_MAGIC_OFFSET);
-                uint32_t magic = header_magic->load(std::memory_order_acquire);
-                last_published_valid_ = (magic == HEADER_MAGIC);
-            }
-            last_published_ = reinterpret_cast<std::atomic<uint64_t>*>(base + LAST_PUBLISHED_OFFSET);
+            map_header(base);
+            apply_page_backing(base);
 
             // Read size from header
-            size_ = *reinterpret_cast<uint32_t*>(
-                base + sizeof(std::atomic<reserved_info>));
-            uint32_t element_size = *reinterpret_cast<uint32_t*>(
-                base + sizeof(std::atomic<reserved_info>) + sizeof(uint32_t));
+            uint32_t element_size;
+            read_geometry(base, size_, element_size);
 
             // Validate
             if (!is_power_of_two(size_)) {
                 throw std::runtime_error("Shared memory size must be power of 2. Got " + std::to_string(size_));
             }
+            if (static_capacity_ != 0 && size_ != static_capacity_) {
+                throw std::runtime_error("Shared memory size mismatch. Expected static capacity " +
+                    std::to_string(static_capacity_) + " but got " + std::to_string(size_));
+            }
             if (element_size != sizeof(T)) {
                 throw std::runtime_error("Shared memory element size mismatch. Expected " +
                     std::to_string(sizeof(T)) + " but got " + std::to_string(element_size));
             }
 
             mask_ = size_ - 1;
+            uint32_t layout;
+            uint32_t mapping;
+            read_layout(base, layout, mapping);
+            if (layout > static_cast<uint32_t>(queue_layout::packed) ||
+                mapping > static_cast<uint32_t>(slot_mapping::swizzled)) {
+                throw std::runtime_error("Unsupported shared memory layout " + std::to_string(layout) +
+                    "/" + std::to_string(mapping));
+            }
+            if ((layout == static_cast<uint32_t>(queue_layout::packed)) != value_in_slot_) {
+                throw std::runtime_error(value_in_slot_ ?
+                    "Shared memory layout mismatch. Expected packed layout of a value_in_slot queue" :
+                    "Shared memory layout mismatch. Segment was created with the value_in_slot policy");
+            }
+            check_compact_slots(base);
+            set_layout(static_cast<queue_layout>(layout), static_cast<slot_mapping>(mapping));
 
             // Map to existing structures
-            reserved_ = reinterpret_cast<std::atomic<reserved_info>*>(base);
-            control_ = reinterpret_cast<slot*>(base + HEADER_SIZE);
-            data_ = reinterpret_cast<T*>(base + HEADER_SIZE + sizeof(slot) * size_);
+            map_arrays(base + arrays_offset());
+            map_occupancy(base);
+            if (mirrored_) {
+                validate_mirror();
+                map_shm_mirror();
+            }
 
         } else {
             // Creator constructor - create or open
-            const size_t total_size = HEADER_SIZE + sizeof(slot) * size_ + sizeof(T) * size_;
-
-            try {
-                shm_ = slick::shm::shared_memory(
-                    shm_name,
-                    total_size,
-                    slick::shm::open_or_create,
-                    slick::shm::access_mode::read_write
-                );
-            } catch (const slick::shm::shared_memory_error& e) {
-                throw std::runtime_error(std::string("Failed to create/open shared memory: ") + e.what());
-            }
-
-            lpvMem_ = shm_.data();
+            map_segment(true);
             if (!lpvMem_) {
                 throw std::runtime_error("Failed to map shared memory");
             }
@@ -620,29 +3580,65 @@ private:
                 expected, INIT_STATE_INITIALIZING, std::memory_order_acq_rel);
 
             if (we_are_creator) {
+#if defined(__linux__)
+                // attachers would map the hugetlbfs file instead of the slick-shm segment created
+                // here, whether or not this creator asked for huge pages
+                if (huge_path_.empty() && huge_segment_exists()) {
+                    slick::shm::shared_memory::remove(shm_name_.c_str());
+                    throw std::runtime_error("Shared memory " + shm_name_ + " exists on hugetlbfs" +
+                        (huge_pages_ ? std::string(" but could not be mapped") : ", create it with queue_options::huge_pages"));
+                }
+#endif
                 // Initialize as creator
                 own_ = true;
+                apply_numa(base, segment_mapped_bytes());
 
                 auto* header_magic = new (base + HEADER_MAGIC_OFFSET) std::atomic<uint32_t>();
-                header_magic->store(HEADER_MAGIC, std::memory_order_release);
+                header_magic->store(HEADER_MAGIC_V2, std::memory_order_release);
 
-                // Initialize atomic header
-                reserved_ = new (base) std::atomic<reserved_info>();
+                // Initialize atomic header, each atomic on its own line pair
+                header_size_ = HEADER_SIZE_V2;
+                reserved_ = new (base + RESERVED_OFFSET_V2) std::atomic<reserved_info>();
                 reserved_->store(0, std::memory_order_relaxed);
 
-                last_published_ = new (base + LAST_PUBLISHED_OFFSET) std::atomic<uint64_t>();
+                last_published_ = new (base + LAST_PUBLISHED_OFFSET_V2) std::atomic<uint64_t>();
                 last_published_->store(kInvalidIndex, std::memory_order_relaxed);
-                last_published_valid_ = true;
-
-                // Write metadata
-                *reinterpret_cast<uint32_t*>(
-                    base + sizeof(std::atomic<reserved_info>)) = size_;
-                *reinterpret_cast<uint32_t*>(
-                    base + sizeof(std::atomic<reserved_info>) + sizeof(uint32_t)) = sizeof(T);
+                last_published_valid_ = !scan_last_published_;
+
+                reset_epoch_ = new (base + RESET_EPOCH_OFFSET_V2) std::atomic<uint64_t>(0);
+                reset_limit_ = new (base + RESET_LIMIT_OFFSET_V2) std::atomic<uint64_t>(0);
+
+                wait_seq_ = new (base + WAIT_SEQ_OFFSET_V2) std::atomic<uint32_t>(0);
+                sleepers_ = new (base + SLEEPERS_OFFSET_V2) std::atomic<uint32_t>(0);
+                notify_armed_ = new (base + NOTIFY_ARMED_OFFSET_V2) std::atomic<uint32_t>(0);
+                shared_wait_state_ = true;
+
+                // Write metadata; the v1 size fields stay zero so that v1 readers fail validation
+                *reinterpret_cast<uint32_t*>(base + SIZE_OFFSET_V2) = size_;
+                *reinterpret_cast<uint32_t*>(base + ELEMENT_SIZE_OFFSET_V2) = sizeof(T);
+                *reinterpret_cast<uint32_t*>(base + LAYOUT_OFFSET) = static_cast<uint32_t>(layout_);
+                *reinterpret_cast<uint32_t*>(base + SLOT_MAPPING_OFFSET) = static_cast<uint32_t>(mapping_);
+                *reinterpret_cast<uint32_t*>(base + FLAGS_OFFSET) =
+                    (scan_last_published_ ? HEADER_FLAG_UNTRACKED_LAST_PUBLISHED : 0) |
+                    (backpressure_ ? HEADER_FLAG_BACKPRESSURE : 0) |
+                    (mirrored_ ? HEADER_FLAG_MIRRORED : 0) |
+                    (uninitialized_ ? HEADER_FLAG_UNINITIALIZED : 0) |
+                    (compact_slots_ ? HEADER_FLAG_COMPACT_SLOTS : 0);
+                *reinterpret_cast<uint32_t*>(base + MAX_CONSUMERS_OFFSET) = max_consumers_;
+                *reinterpret_cast<uint32_t*>(base + PAGE_BACKING_OFFSET) = static_cast<uint32_t>(backing_);
+                consumer_count_ = new (base + CONSUMER_COUNT_OFFSET_V2) std::atomic<uint32_t>(0);
+                if (backpressure_) {
+                    gating_ = base + header_size_;
+                    construct_gating();
+                }
 
                 // Placement-new arrays
-                control_ = new (base + HEADER_SIZE) slot[size_];
-                data_ = new (base + HEADER_SIZE + sizeof(slot) * size_) T[size_];
+                map_arrays(base + arrays_offset());
+                map_occupancy(base);
+                if (mirrored_) {
+                    map_shm_mirror();
+                }
+                construct_arrays();
 
                 init_state->store(INIT_STATE_READY, std::memory_order_release);
 
@@ -654,20 +3650,17 @@ private:
                     throw std::runtime_error("Timed out waiting for shared memory initialization");
                 }
 
-                uint32_t state = init_state->load(std::memory_order_acquire);
-                last_published_valid_ = false;
-                if (state == INIT_STATE_READY) {
-                    auto* header_magic = reinterpret_cast<std::atomic<uint32_t>*>(base + HEADER_MAGIC_OFFSET);
-                    uint32_t magic = header_magic->load(std::memory_order_acquire);
-                    last_published_valid_ = (magic == HEADER_MAGIC);
-                }
-                last_published_ = reinterpret_cast<std::atomic<uint64_t>*>(base + LAST_PUBLISHED_OFFSET);
+                bool track_last_published = !scan_last_published_;
+                uint32_t max_consumers = max_consumers_;
+                bool mirrored = mirrored_;
+                bool uninitialized = uninitialized_;
+                map_header(base);
+                apply_page_backing(base);
 
                 // Read and validate metadata
-                uint32_t shm_size = *reinterpret_cast<uint32_t*>(
-                    base + sizeof(std::atomic<reserved_info>));
-                uint32_t element_size = *reinterpret_cast<uint32_t*>(
-                    base + sizeof(std::atomic<reserved_info>) + sizeof(uint32_t));
+                uint32_t shm_size;
+                uint32_t element_size;
+                read_geometry(base, shm_size, element_size);
 
                 if (shm_size != size_) {
                     throw std::runtime_error("Shared memory size mismatch. Expected " +
@@ -677,11 +3670,38 @@ private:
                     throw std::runtime_error("Shared memory element size mismatch. Expected " +
                         std::to_string(sizeof(T)) + " but got " + std::to_string(element_size));
                 }
+                uint32_t layout;
+                uint32_t mapping;
+                read_layout(base, layout, mapping);
+                if (layout != static_cast<uint32_t>(layout_)) {
+                    throw std::runtime_error("Shared memory layout mismatch. Expected " +
+                        std::to_string(static_cast<uint32_t>(layout_)) + " but got " + std::to_string(layout));
+                }
+                if (mapping != static_cast<uint32_t>(mapping_)) {
+                    throw std::runtime_error("Shared memory slot mapping mismatch. Expected " +
+                        std::to_string(static_cast<uint32_t>(mapping_)) + " but got " + std::to_string(mapping));
+                }
+                if (header_size_ == HEADER_SIZE_V2 && track_last_published == scan_last_published_) {
+                    throw std::runtime_error("Shared memory last published tracking mismatch");
+                }
+                if (max_consumers != max_consumers_) {
+                    throw std::runtime_error("Shared memory backpressure mismatch. Expected " +
+                        std::to_string(max_consumers) + " consumers but got " + std::to_string(max_consumers_));
+                }
+                if (mirrored != mirrored_) {
+                    throw std::runtime_error("Shared memory mirrored ring mismatch");
+                }
+                if (uninitialized != uninitialized_) {
+                    throw std::runtime_error("Shared memory uninitialized storage mismatch");
+                }
+                check_compact_slots(base);
 
                 // Map to existing structures
-                reserved_ = reinterpret_cast<std::atomic<reserved_info>*>(base);
-                control_ = reinterpret_cast<slot*>(base + HEADER_SIZE);
-                data_ = reinterpret_cast<T*>(base + HEADER_SIZE + sizeof(slot) * size_);
+                map_arrays(base + arrays_offset());
+                map_occupancy(base);
+                if (mirrored_) {
+                    map_shm_mirror();
+                }
             }
         }
     }
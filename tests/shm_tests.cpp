@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <slick/queue.h>
+#include <slick/byte_queue.h>
+#include <memory>
 #include <thread>
 
 using namespace slick;
@@ -283,3 +285,486 @@ TEST(ShmTests, ReadLastIgnoresUnpublishedReservationMultiple) {
   EXPECT_EQ(strncmp(latest, first_str, size), 0);
 }
 
+
+TEST(ShmTests, InterleavedLayoutServerClient) {
+  SlickQueue<int> server(4, "sq_interleaved", queue_options{ .layout = queue_layout::interleaved });
+  SlickQueue<int> client("sq_interleaved");
+  EXPECT_EQ(client.layout(), queue_layout::interleaved);
+
+  for (int i = 0; i < 6; ++i) {
+    auto slot = server.reserve();
+    *server[slot] = i * 10;
+    server.publish(slot);
+  }
+
+  uint64_t read_cursor = 2;
+  for (int i = 2; i < 6; ++i) {
+    auto read = client.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i * 10);
+  }
+  EXPECT_EQ(client.read(read_cursor).first, nullptr);
+}
+
+TEST(ShmTests, LayoutMismatch) {
+  SlickQueue<int> server(4, "sq_layout_mismatch");
+  EXPECT_THROW({
+    SlickQueue<int> other(4, "sq_layout_mismatch", queue_options{ .layout = queue_layout::interleaved });
+  }, std::runtime_error);
+}
+
+TEST(ShmTests, ValueInSlotAcrossInstances) {
+  SlickQueue<uint64_t, value_in_slot> server(32, "sq_value_in_slot", queue_options{ .mapping = slot_mapping::swizzled });
+  SlickQueue<uint64_t, value_in_slot> client("sq_value_in_slot");
+  EXPECT_EQ(client.layout(), queue_layout::packed);
+  EXPECT_EQ(client.mapping(), slot_mapping::swizzled);
+  for (uint64_t i = 0; i < 50; ++i) {
+    auto slot = server.reserve();
+    *server[slot] = i << 32;
+    server.publish(slot);
+  }
+  uint64_t read_cursor = 18;
+  for (uint64_t i = 18; i < 50; ++i) {
+    auto read = client.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i << 32);
+  }
+  EXPECT_EQ(client.read(read_cursor).first, nullptr);
+
+  // the packed layout and the separate layout cannot attach to each other
+  EXPECT_THROW(SlickQueue<uint64_t>("sq_value_in_slot"), std::runtime_error);
+  SlickQueue<uint64_t> separate(32, "sq_value_in_slot_separate");
+  EXPECT_THROW((SlickQueue<uint64_t, value_in_slot>("sq_value_in_slot_separate")), std::runtime_error);
+}
+
+TEST(ShmTests, CompactSlotsAcrossInstances) {
+  SlickQueue<int, compact_slots> server(64, "sq_compact_slots", queue_options{ .mapping = slot_mapping::swizzled });
+  SlickQueue<int, compact_slots> client("sq_compact_slots");
+  EXPECT_TRUE(client.compact_slots());
+  for (int i = 0; i < 100; ++i) {
+    auto slot = client.reserve();
+    *client[slot] = i;
+    client.publish(slot);
+  }
+  uint64_t read_cursor = 40;
+  for (int i = 40; i < 100; ++i) {
+    auto read = server.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(*client.read_last().first, 99);
+
+  // the encoding is part of the type, either way round
+  EXPECT_THROW((SlickQueue<int>(64, "sq_compact_slots")), std::runtime_error);
+  EXPECT_THROW((SlickQueue<int>("sq_compact_slots")), std::runtime_error);
+  SlickQueue<int> wide(64, "sq_compact_slots_wide");
+  EXPECT_THROW((SlickQueue<int, compact_slots>("sq_compact_slots_wide")), std::runtime_error);
+}
+
+TEST(ShmTests, StaticCapacityAttachesToRuntimeSize) {
+  SlickQueue<int, static_capacity<64>> server(64, "sq_static_capacity");
+  SlickQueue<int> client("sq_static_capacity");
+  SlickQueue<int, static_capacity<64>> static_client("sq_static_capacity");
+  EXPECT_EQ(client.size(), 64u);
+  for (int i = 0; i < 100; ++i) {
+    auto slot = client.reserve();
+    *client[slot] = i;
+    client.publish(slot);
+  }
+  uint64_t read_cursor = 36;
+  uint64_t static_cursor = 36;
+  for (int i = 36; i < 100; ++i) {
+    EXPECT_EQ(*server.read(read_cursor).first, i);
+    EXPECT_EQ(*static_client.read(static_cursor).first, i);
+  }
+
+  EXPECT_THROW((SlickQueue<int, static_capacity<128>>("sq_static_capacity")), std::runtime_error);
+}
+
+TEST(ShmTests, SlotMappingServerClient) {
+  SlickQueue<int> server(64, "sq_slot_mapping", queue_options{ .mapping = slot_mapping::swizzled });
+  SlickQueue<int> client("sq_slot_mapping");
+  EXPECT_EQ(client.mapping(), slot_mapping::swizzled);
+
+  for (int i = 0; i < 100; ++i) {
+    auto slot = server.reserve();
+    *server[slot] = i;
+    server.publish(slot);
+  }
+
+  uint64_t read_cursor = 50;
+  for (int i = 50; i < 100; ++i) {
+    auto read = client.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_THROW({
+    SlickQueue<int> other(64, "sq_slot_mapping", queue_options{ .mapping = slot_mapping::padded });
+  }, std::runtime_error);
+}
+
+TEST(ShmTests, HeaderV2KeepsHotAtomicsOnSeparateLines) {
+  SlickQueue<int> server(4, "sq_header_v2");
+  slick::shm::shared_memory raw("sq_header_v2", slick::shm::open_existing, slick::shm::access_mode::read_write);
+  auto* base = static_cast<uint8_t*>(raw.data());
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 24), 0x534C5132u);  // 'SLQ2'
+  // v1 readers find a zero size and reject the segment, the real geometry is in line pair 0
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 8), 0u);
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 12), 0u);
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 64), 4u);
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 68), sizeof(int));
+
+  auto slot = server.reserve();
+  *server[slot] = 7;
+  server.publish(slot);
+  EXPECT_EQ(*reinterpret_cast<uint64_t*>(base + 128), (1ULL << 16) | 1);  // reserved cursor
+  EXPECT_EQ(*reinterpret_cast<uint64_t*>(base + 256), 0u);                // last published
+  EXPECT_EQ(*reinterpret_cast<uint64_t*>(base + 384), 0u);                // reset epoch
+  EXPECT_EQ(*reinterpret_cast<uint64_t*>(base), 0u);
+
+  server.reset();
+  EXPECT_EQ(*reinterpret_cast<uint64_t*>(base + 384), 1u);
+}
+
+TEST(ShmTests, AttachToV1Segment) {
+  // Hand-built segment in the 64-byte v1 header layout
+  constexpr uint32_t size = 4;
+  constexpr size_t header_size = 64;
+  constexpr size_t slot_size = 16;
+  // Keep the raw mapping open so the segment outlives this block on Windows
+  slick::shm::shared_memory raw("sq_header_v1", header_size + (slot_size + sizeof(int)) * size,
+    slick::shm::open_or_create, slick::shm::access_mode::read_write);
+  {
+    auto* base = static_cast<uint8_t*>(raw.data());
+    *reinterpret_cast<uint64_t*>(base) = (1ULL << 16) | 1;  // one reserved
+    *reinterpret_cast<uint32_t*>(base + 8) = size;
+    *reinterpret_cast<uint32_t*>(base + 12) = sizeof(int);
+    *reinterpret_cast<uint64_t*>(base + 16) = 0;             // last published
+    *reinterpret_cast<uint32_t*>(base + 24) = 0x534C5131;    // 'SLQ1'
+    *reinterpret_cast<uint32_t*>(base + 28) = 1;             // stray layout field, v1 is always separate
+    for (uint32_t i = 0; i < size; ++i) {
+      *reinterpret_cast<uint64_t*>(base + header_size + i * slot_size) = i == 0 ? 0 : ~0ULL;
+      *reinterpret_cast<uint32_t*>(base + header_size + i * slot_size + 8) = 1;
+    }
+    *reinterpret_cast<int*>(base + header_size + slot_size * size) = 42;
+    *reinterpret_cast<uint32_t*>(base + 48) = 3;             // ready
+  }
+
+  {
+    SlickQueue<int> client("sq_header_v1");
+    uint64_t read_cursor = 0;
+    auto read = client.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, 42);
+    EXPECT_EQ(*client.read_last().first, 42);
+
+    auto slot = client.reserve();
+    EXPECT_EQ(slot, 1u);
+    *client[slot] = 43;
+    client.publish(slot);
+    read = client.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, 43);
+  }
+#if !defined(_MSC_VER)
+  slick::shm::shared_memory::remove("sq_header_v1");
+#endif
+}
+
+TEST(ShmTests, UntrackedLastPublishedServerClient) {
+  SlickQueue<int> server(8, "sq_untracked_last", queue_options{ .track_last_published = false });
+  SlickQueue<int> client("sq_untracked_last");
+  EXPECT_FALSE(client.tracks_last_published());
+
+  for (int i = 0; i < 10; ++i) {
+    auto slot = server.reserve();
+    *server[slot] = i;
+    server.publish(slot);
+  }
+  auto [latest, size] = client.read_last();
+  ASSERT_NE(latest, nullptr);
+  EXPECT_EQ(*latest, 9);
+
+  EXPECT_THROW({
+    SlickQueue<int> other(8, "sq_untracked_last");
+  }, std::runtime_error);
+}
+
+TEST(ShmTests, SingleProducerWithRegularConsumer) {
+  SlickQueue<int, single_producer> server(8, "sq_single_producer");
+  SlickQueue<int> client("sq_single_producer");
+
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 20; ++i) {
+    auto slot = server.reserve();
+    *server[slot] = i;
+    server.publish(slot);
+    auto read = client.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(*client.read_last().first, 19);
+
+  // a single producer attaching to an existing segment continues from its cursor
+  SlickQueue<int, single_producer> successor("sq_single_producer");
+  EXPECT_EQ(successor.reserve(), 20u);
+}
+
+TEST(ShmTests, BackpressureGatesAcrossInstances) {
+  SlickQueue<int> server(4, "sq_backpressure", queue_options{ .backpressure = true, .max_consumers = 4 });
+  SlickQueue<int> client("sq_backpressure");
+  EXPECT_TRUE(client.backpressure());
+  auto consumer = client.register_consumer();
+
+  for (int i = 0; i < 4; ++i) {
+    auto slot = server.try_reserve();
+    ASSERT_TRUE(slot.has_value());
+    *server[*slot] = i;
+    server.publish(*slot);
+  }
+  EXPECT_FALSE(server.try_reserve().has_value());
+
+  uint64_t read_cursor = 0;
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  client.commit(consumer, read_cursor);
+  EXPECT_EQ(server.try_reserve(), 4u);
+
+  EXPECT_THROW({
+    SlickQueue<int> other(4, "sq_backpressure");
+  }, std::runtime_error);
+}
+
+TEST(ShmTests, ClientRewindsAfterServerReset) {
+  SlickQueue<int> server(8, "sq_reset_epoch");
+  SlickQueue<int> client("sq_reset_epoch");
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 5; ++i) {
+    auto slot = server.reserve();
+    *server[slot] = i;
+    server.publish(slot);
+  }
+  while (client.read(read_cursor).first) {}
+  EXPECT_EQ(read_cursor, 5u);
+
+  server.reset();
+  auto slot = server.reserve();
+  *server[slot] = 42;
+  server.publish(slot);
+
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+  EXPECT_EQ(read_cursor, 1u);
+}
+
+TEST(ShmTests, BlockingWaitAcrossInstances) {
+  SlickQueue<int> server(16, "sq_blocking_wait");
+  SlickQueue<int> client("sq_blocking_wait");
+  std::atomic<int> received{ -1 };
+  std::thread consumer([&]() {
+    uint64_t read_cursor = 0;
+    auto read = client.read_wait<blocking_wait>(read_cursor, std::chrono::seconds(10));
+    if (read.first) {
+      received = *read.first;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  slick::shm::shared_memory raw("sq_blocking_wait", slick::shm::open_existing, slick::shm::access_mode::read_write);
+  auto* base = static_cast<uint8_t*>(raw.data());
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 516), 1u);  // consumer asleep on the futex
+
+  auto slot = server.reserve();
+  *server[slot] = 42;
+  server.publish(slot);
+  consumer.join();
+  EXPECT_EQ(received.load(), 42);
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(base + 516), 0u);  // no sleepers left
+}
+
+#if defined(__linux__)
+#include <poll.h>
+
+TEST(ShmTests, NotifierAcrossInstances) {
+  SlickQueue<int> server(16, "sq_notifier");
+  SlickQueue<int> client("sq_notifier");
+  uint64_t read_cursor = 0;
+  int fd = client.notifier();
+  EXPECT_TRUE(client.arm_notifier(read_cursor));
+
+  auto slot = server.reserve();
+  *server[slot] = 42;
+  server.publish(slot);
+
+  pollfd pfd{ fd, POLLIN, 0 };
+  ASSERT_EQ(::poll(&pfd, 1, 1000), 1);
+  client.drain_notifier();
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+
+  // a second consumer cannot take over the notifier
+  SlickQueue<int> other("sq_notifier");
+  EXPECT_THROW(other.notifier(), std::runtime_error);
+}
+#endif
+
+#if defined(__linux__)
+TEST(ShmTests, MirroredAcrossInstances) {
+  SlickQueue<int> server(1024, "sq_mirrored", queue_options{ .mirrored = true });
+  SlickQueue<int> client("sq_mirrored");
+  EXPECT_TRUE(client.mirrored());
+  slick::shm::shared_memory raw("sq_mirrored", slick::shm::open_existing, slick::shm::access_mode::read_write);
+  EXPECT_EQ(*reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(raw.data()) + 36) & 4u, 4u);
+
+  auto warmup = server.reserve(1000);
+  server.publish(warmup, 1000);
+  auto slot = server.reserve(50);
+  EXPECT_EQ(slot, 1000u);
+  for (int i = 0; i < 50; ++i) {
+    server[slot][i] = i;
+  }
+  server.publish(slot, 50);
+
+  uint64_t read_cursor = 1000;
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(read.second, 50u);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(read.first[i], i);
+  }
+  EXPECT_EQ(*client[0], 24);
+
+  EXPECT_THROW((SlickQueue<int>(1024, "sq_mirrored")), std::runtime_error);
+}
+#endif
+
+TEST(ShmTests, HugePagesFollowTheCreator) {
+  SlickQueue<int> server(1024, "sq_huge_pages", queue_options{ .huge_pages = true });
+  SlickQueue<int> client("sq_huge_pages");
+  EXPECT_EQ(client.backing(), server.backing());
+  EXPECT_EQ(client.page_size(), server.page_size());
+  if (server.backing() != page_backing::huge) {
+    slick::shm::shared_memory raw("sq_huge_pages", slick::shm::open_existing, slick::shm::access_mode::read_write);
+    EXPECT_EQ(*reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(raw.data()) + 44), static_cast<uint32_t>(server.backing()));
+  }
+
+  auto slot = server.reserve();
+  *server[slot] = 42;
+  server.publish(slot);
+  uint64_t read_cursor = 0;
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+}
+
+#if defined(__linux__)
+TEST(ShmTests, HugePagesCreatorLosingTheRaceWaitsForTheWinner) {
+  SlickQueue<int> reference(1024, "sq_huge_reference", queue_options{ .huge_pages = true });
+  if (reference.backing() != page_backing::huge) {
+    GTEST_SKIP() << "no hugetlbfs pages at " SLICK_QUEUE_HUGETLBFS_DIR;
+  }
+  struct stat st {};
+  ASSERT_EQ(::stat(SLICK_QUEUE_HUGETLBFS_DIR "/sq_huge_reference", &st), 0);
+
+  // the winning creator has created its hugetlbfs file but not sized it yet
+  const char* path = SLICK_QUEUE_HUGETLBFS_DIR "/sq_huge_race";
+  ::unlink(path);
+  int fd = ::open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+  ASSERT_GE(fd, 0);
+  std::unique_ptr<SlickQueue<int>> loser;
+  std::thread creator([&]() {
+    loser = std::make_unique<SlickQueue<int>>(1024, "sq_huge_race", queue_options{ .huge_pages = true });
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  int sized = ::ftruncate(fd, st.st_size);
+  ::close(fd);
+  creator.join();
+  ASSERT_EQ(sized, 0);
+
+  // the loser shares the hugetlbfs file instead of creating a regular segment of the same name
+  ASSERT_TRUE(loser);
+  EXPECT_EQ(loser->backing(), page_backing::huge);
+  EXPECT_THROW(slick::shm::shared_memory("sq_huge_race", slick::shm::open_existing, slick::shm::access_mode::read_write),
+    slick::shm::shared_memory_error);
+  SlickQueue<int> client("sq_huge_race");
+  auto slot = loser->reserve();
+  *(*loser)[slot] = 42;
+  loser->publish(slot);
+  uint64_t read_cursor = 0;
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+}
+#endif
+
+#if defined(__linux__)
+TEST(ShmTests, NumaPlacementCoversTheSegment) {
+  SlickQueue<uint64_t> server(1u << 12, "sq_numa", queue_options{ .numa = numa_policy::bind, .numa_node = 0 });
+  auto placement = server.numa_placement();
+  ASSERT_FALSE(placement.empty());
+  // header and control array were touched by the creator, the data array of a trivial T was not
+  EXPECT_GE(placement[0], (1024 + 16 * (1u << 12)) / 4096);
+  EXPECT_LT(placement[0], (1024 + (sizeof(uint64_t) + 16) * (1u << 12)) / 4096);
+
+  // an attacher counts the pages it touched, on the node the creator chose
+  SlickQueue<uint64_t> client("sq_numa");
+  uint64_t read_cursor = 0;
+  EXPECT_EQ(client.read(read_cursor).first, nullptr);
+  placement = client.numa_placement();
+  ASSERT_FALSE(placement.empty());
+  EXPECT_GT(placement[0], 0u);
+}
+#endif
+
+TEST(ShmTests, AttacherWarmUp) {
+  SlickQueue<int> server(1u << 16, "sq_warm_up");
+  auto slot = server.reserve();
+  *server[slot] = 42;
+  server.publish(slot);
+
+  SlickQueue<int> client("sq_warm_up", warm_up_options{ .prefault = true, .lock = true, .threads = 4 });
+  EXPECT_GT(client.warm_up_time().count(), 0);
+  uint64_t read_cursor = 0;
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+}
+
+namespace {
+struct quote {
+  quote(uint32_t b, uint32_t a) : bid(b), ask(a) {}
+  uint32_t bid;
+  uint32_t ask;
+};
+}
+
+TEST(ShmTests, UninitializedStorageAcrossInstances) {
+  SlickQueue<quote> server(64, "sq_uninitialized", queue_options{ .uninitialized = true });
+  SlickQueue<quote> client("sq_uninitialized");
+  EXPECT_TRUE(client.uninitialized());
+  auto slot = server.reserve();
+  server.emplace(slot, 100u, 101u);
+  server.publish(slot);
+  uint64_t read_cursor = 0;
+  auto read = client.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(read.first->ask, 101u);
+
+  EXPECT_THROW((SlickQueue<uint64_t>(64, "sq_uninitialized")), std::runtime_error);
+}
+
+TEST(ShmTests, ByteQueueAcrossInstances) {
+  SlickByteQueue<> server(4096, "sq_byte_queue");
+  SlickByteQueue<> client("sq_byte_queue");
+  EXPECT_EQ(client.capacity(), 4096u);
+  std::string message = "35=8|150=F|39=2|";
+  server.push(std::as_bytes(std::span(message.data(), message.size())));
+  uint64_t read_cursor = 0;
+  auto read = client.read(read_cursor);
+  ASSERT_EQ(read.size(), message.size());
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(read.data()), read.size()), message);
+
+  // a queue of a different chunk size cannot attach
+  EXPECT_THROW(SlickByteQueue<32>("sq_byte_queue"), std::runtime_error);
+}
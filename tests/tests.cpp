@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
 #include <slick/queue.h>
+#include <slick/byte_queue.h>
 #include <thread>
+#include <chrono>
+#include <coroutine>
+#include <mutex>
 #include <cstring>
+#include <memory_resource>
+#include <string>
+#include <vector>
 
 using namespace slick;
 
@@ -285,3 +292,1653 @@ TEST(SlickQueueTests, AtomicCursorWorkStealing) {
   EXPECT_EQ(total_consumed.load(), 200);
   EXPECT_EQ(shared_cursor.load(), 200);
 }
+
+TEST(SlickQueueTests, InterleavedLayoutPublishAndRead) {
+  SlickQueue<int> queue(4, queue_options{ .layout = queue_layout::interleaved });
+  EXPECT_EQ(queue.layout(), queue_layout::interleaved);
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 6; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+    EXPECT_EQ(read.second, 1u);
+  }
+  EXPECT_EQ(read_cursor, 6);
+
+  auto [latest, size] = queue.read_last();
+  ASSERT_NE(latest, nullptr);
+  EXPECT_EQ(*latest, 5);
+  EXPECT_EQ(size, 1u);
+}
+
+TEST(SlickQueueTests, InterleavedLayoutRecordsAreCacheAligned) {
+  SlickQueue<int> queue(8, queue_options{ .layout = queue_layout::interleaved });
+  auto first = reinterpret_cast<uintptr_t>(queue[0]);
+  auto second = reinterpret_cast<uintptr_t>(queue[1]);
+  EXPECT_EQ((second - first) % 64, 0u);
+  EXPECT_EQ(first / 64, (first - sizeof(uint64_t)) / 64);
+}
+
+TEST(SlickQueueTests, InterleavedLayoutRejectsMultiSlotReserve) {
+  SlickQueue<char> queue(8, queue_options{ .layout = queue_layout::interleaved });
+  EXPECT_THROW({
+    queue.reserve(2);
+  }, std::invalid_argument);
+}
+
+TEST(SlickQueueTests, SlotMappingPublishAndRead) {
+  for (auto mapping : { slot_mapping::padded, slot_mapping::swizzled }) {
+    SlickQueue<int> queue(16, queue_options{ .mapping = mapping });
+    EXPECT_EQ(queue.mapping(), mapping);
+    uint64_t read_cursor = 0;
+    for (int i = 0; i < 40; ++i) {
+      auto slot = queue.reserve();
+      *queue[slot] = i;
+      queue.publish(slot);
+      auto read = queue.read(read_cursor);
+      ASSERT_NE(read.first, nullptr);
+      EXPECT_EQ(*read.first, i);
+    }
+    EXPECT_EQ(read_cursor, 40);
+    EXPECT_EQ(*queue.read_last().first, 39);
+  }
+}
+
+TEST(SlickQueueTests, SlotMappingBufferWrap) {
+  for (auto mapping : { slot_mapping::padded, slot_mapping::swizzled }) {
+    SlickQueue<char> queue(8, queue_options{ .mapping = mapping });
+    uint64_t read_cursor = 0;
+    for (uint64_t expected : { 0, 3, 8, 11, 16 }) {
+      auto reserved = queue.reserve(3);
+      EXPECT_EQ(reserved, expected);
+      memcpy(queue[reserved], "abc", 3);
+      queue.publish(reserved, 3);
+      auto read = queue.read(read_cursor);
+      ASSERT_NE(read.first, nullptr);
+      EXPECT_EQ(read.second, 3u);
+      EXPECT_EQ(strncmp(read.first, "abc", 3), 0);
+      EXPECT_EQ(read_cursor, expected + 3);
+    }
+  }
+}
+
+TEST(SlickQueueTests, InterleavedLayoutRejectsSlotMapping) {
+  EXPECT_THROW({
+    SlickQueue<int> queue(8, queue_options{ .layout = queue_layout::interleaved, .mapping = slot_mapping::padded });
+  }, std::invalid_argument);
+}
+
+TEST(SlickQueueTests, UntrackedLastPublishedReadLast) {
+  SlickQueue<int> queue(8, queue_options{ .track_last_published = false });
+  EXPECT_FALSE(queue.tracks_last_published());
+  EXPECT_EQ(queue.read_last().first, nullptr);
+
+  auto first = queue.reserve(2);
+  *queue[first] = 1;
+  *queue[first + 1] = 2;
+  queue.publish(first, 2);
+
+  auto last = queue.reserve(1);
+  *queue[last] = 3;
+
+  auto [latest, size] = queue.read_last();
+  ASSERT_NE(latest, nullptr);
+  EXPECT_EQ(*latest, 1);
+  EXPECT_EQ(size, 2u);
+
+  queue.publish(last, 1);
+  std::tie(latest, size) = queue.read_last();
+  ASSERT_NE(latest, nullptr);
+  EXPECT_EQ(*latest, 3);
+  EXPECT_EQ(size, 1u);
+
+  // wrap marker slots are skipped
+  auto wrapped = queue.reserve(6);
+  EXPECT_EQ(wrapped, 8u);
+  *queue[wrapped] = 4;
+  queue.publish(wrapped, 6);
+  std::tie(latest, size) = queue.read_last();
+  ASSERT_NE(latest, nullptr);
+  EXPECT_EQ(*latest, 4);
+  EXPECT_EQ(size, 6u);
+}
+
+TEST(SlickQueueTests, SingleProducerReserveAndRead) {
+  SlickQueue<int, single_producer> queue(4);
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 10; ++i) {
+    auto slot = queue.reserve();
+    EXPECT_EQ(slot, static_cast<uint64_t>(i));
+    *queue[slot] = i;
+    queue.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(*queue.read_last().first, 9);
+  EXPECT_EQ(queue.initial_reading_index(), 10u);
+}
+
+TEST(SlickQueueTests, SingleProducerBufferWrap) {
+  SlickQueue<char, single_producer> queue(8);
+  uint64_t read_cursor = 0;
+  for (uint64_t expected : { 0, 3, 8, 11, 16 }) {
+    auto reserved = queue.reserve(3);
+    EXPECT_EQ(reserved, expected);
+    memcpy(queue[reserved], "xyz", 3);
+    queue.publish(reserved, 3);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(strncmp(read.first, "xyz", 3), 0);
+    EXPECT_EQ(read_cursor, expected + 3);
+  }
+}
+
+TEST(SlickQueueTests, SingleProducerOutOfOrderPublishKeepsLatest) {
+  SlickQueue<int, single_producer> queue(8);
+  auto first = queue.reserve();
+  auto second = queue.reserve();
+  *queue[first] = 1;
+  *queue[second] = 2;
+  queue.publish(second);
+  queue.publish(first);
+  EXPECT_EQ(*queue.read_last().first, 2);
+}
+
+TEST(SlickQueueTests, BackpressureRefusesOverwrite) {
+  SlickQueue<int> queue(4, queue_options{ .backpressure = true, .max_consumers = 2 });
+  EXPECT_TRUE(queue.backpressure());
+  auto consumer = queue.register_consumer();
+
+  for (int i = 0; i < 4; ++i) {
+    auto slot = queue.try_reserve();
+    ASSERT_TRUE(slot.has_value());
+    *queue[*slot] = i;
+    queue.publish(*slot);
+  }
+  EXPECT_FALSE(queue.try_reserve().has_value());
+
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 2; ++i) {
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  queue.commit(consumer, read_cursor);
+  EXPECT_EQ(queue.try_reserve(), 4u);
+  EXPECT_EQ(queue.try_reserve(), 5u);
+  EXPECT_FALSE(queue.try_reserve().has_value());
+  EXPECT_FALSE(queue.try_reserve(3).has_value());
+
+  // unregistered consumers no longer gate producers
+  queue.unregister_consumer(consumer);
+  EXPECT_EQ(queue.try_reserve(), 6u);
+}
+
+TEST(SlickQueueTests, BackpressureWithoutConsumersDoesNotBlock) {
+  SlickQueue<int, single_producer> queue(2, queue_options{ .backpressure = true });
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(queue.try_reserve(), i);
+  }
+}
+
+TEST(SlickQueueTests, BackpressureRequiresRegistration) {
+  SlickQueue<int> lossy(4);
+  EXPECT_THROW(lossy.register_consumer(), std::runtime_error);
+
+  SlickQueue<int> queue(4, queue_options{ .backpressure = true, .max_consumers = 1 });
+  queue.register_consumer();
+  EXPECT_THROW(queue.register_consumer(), std::runtime_error);
+}
+
+TEST(SlickQueueTests, BackpressureGatesAfterConsumersComeAndGo) {
+  SlickQueue<int, single_producer> queue(2, queue_options{ .backpressure = true, .max_consumers = 2 });
+  auto first = queue.register_consumer();
+  auto second = queue.register_consumer();
+  queue.unregister_consumer(first);
+  queue.unregister_consumer(first);
+  EXPECT_EQ(queue.try_reserve(), 0u);
+  EXPECT_EQ(queue.try_reserve(), 1u);
+  EXPECT_FALSE(queue.try_reserve().has_value());
+
+  queue.unregister_consumer(second);
+  for (uint64_t i = 2; i < 8; ++i) {
+    EXPECT_EQ(queue.try_reserve(), i);
+  }
+  queue.register_consumer();
+  EXPECT_EQ(queue.try_reserve(), 8u);
+  EXPECT_EQ(queue.try_reserve(), 9u);
+  EXPECT_FALSE(queue.try_reserve().has_value());
+}
+
+TEST(SlickQueueTests, BackpressureIsLossless) {
+  SlickQueue<int> queue(8, queue_options{ .backpressure = true });
+  constexpr int kItems = 2000;
+  auto consumer_id = queue.register_consumer();
+
+  std::thread producers[2];
+  for (auto& producer : producers) {
+    producer = std::thread([&]() {
+      for (int i = 0; i < kItems / 2; ++i) {
+        auto slot = queue.reserve();
+        *queue[slot] = 1;
+        queue.publish(slot);
+      }
+    });
+  }
+
+  uint64_t read_cursor = 0;
+  int64_t sum = 0;
+  while (read_cursor < kItems) {
+    auto read = queue.read(read_cursor);
+    if (read.first) {
+      sum += *read.first;
+      queue.commit(consumer_id, read_cursor);
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(sum, kItems);
+  EXPECT_EQ(queue.loss_count(), 0u);
+}
+
+TEST(SlickQueueTests, ReadBatchStopsAtUnpublishedSlot) {
+  SlickQueue<int> queue(8);
+  uint64_t read_cursor = 0;
+  EXPECT_TRUE(queue.read_batch(read_cursor).empty());
+
+  uint64_t slots[5];
+  for (int i = 0; i < 5; ++i) {
+    slots[i] = queue.reserve();
+    *queue[slots[i]] = i;
+  }
+  for (int i : { 0, 1, 2, 4 }) {
+    queue.publish(slots[i]);
+  }
+
+  auto batch = queue.read_batch(read_cursor);
+  ASSERT_EQ(batch.size(), 3u);
+  EXPECT_EQ(batch[0], 0);
+  EXPECT_EQ(batch[2], 2);
+  EXPECT_EQ(read_cursor, 3u);
+  EXPECT_TRUE(queue.read_batch(read_cursor).empty());
+
+  queue.publish(slots[3]);
+  batch = queue.read_batch(read_cursor, 1);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0], 3);
+  batch = queue.read_batch(read_cursor);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0], 4);
+  EXPECT_EQ(read_cursor, 5u);
+}
+
+TEST(SlickQueueTests, ReadBatchStopsAtPhysicalWrap) {
+  SlickQueue<int> queue(4);
+  for (int i = 0; i < 6; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+  uint64_t read_cursor = 2;
+  auto batch = queue.read_batch(read_cursor);
+  ASSERT_EQ(batch.size(), 2u);
+  EXPECT_EQ(batch[0], 2);
+  EXPECT_EQ(batch[1], 3);
+  batch = queue.read_batch(read_cursor);
+  ASSERT_EQ(batch.size(), 2u);
+  EXPECT_EQ(batch[0], 4);
+  EXPECT_EQ(batch[1], 5);
+}
+
+TEST(SlickQueueTests, PollInvokesHandlerPerEntry) {
+  SlickQueue<char> queue(16);
+  const char* words[] = { "ab", "cde", "f", "ghij" };
+  for (auto word : words) {
+    auto n = static_cast<uint32_t>(strlen(word));
+    auto slot = queue.reserve(n);
+    memcpy(queue[slot], word, n);
+    queue.publish(slot, n);
+  }
+
+  uint64_t read_cursor = 0;
+  std::vector<std::string> seen;
+  auto handler = [&](char* data, uint32_t size) { seen.emplace_back(data, size); };
+  EXPECT_EQ(queue.poll(read_cursor, handler, 2), 2u);
+  EXPECT_EQ(queue.poll(read_cursor, handler), 2u);
+  EXPECT_EQ(queue.poll(read_cursor, handler), 0u);
+  ASSERT_EQ(seen.size(), 4u);
+  EXPECT_EQ(seen[1], "cde");
+  EXPECT_EQ(seen[3], "ghij");
+  EXPECT_EQ(read_cursor, 10u);
+
+  // poll stops at a wrap marker, the next call follows it
+  auto slot = queue.reserve(8);
+  EXPECT_EQ(slot, 16u);
+  memcpy(queue[slot], "wrapped!", 8);
+  queue.publish(slot, 8);
+  EXPECT_EQ(queue.poll(read_cursor, handler), 1u);
+  EXPECT_EQ(seen.back(), "wrapped!");
+  EXPECT_EQ(read_cursor, 24u);
+}
+
+TEST(SlickQueueTests, AtomicCursorBatchClaimAdaptsToBacklog) {
+  SlickQueue<int> queue(64);
+  std::atomic<uint64_t> shared_cursor{0};
+  EXPECT_TRUE(queue.read_batch(shared_cursor).empty());
+
+  for (int i = 0; i < 30; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+
+  // a run longer than max is claimed in full
+  auto batch = queue.read_batch(shared_cursor, 8);
+  ASSERT_EQ(batch.size(), 8u);
+  EXPECT_EQ(batch[0], 0);
+  EXPECT_EQ(batch[7], 7);
+
+  // a shorter run is split so other consumers get a share
+  batch = queue.read_batch(shared_cursor);
+  ASSERT_EQ(batch.size(), 12u);
+  EXPECT_EQ(batch[0], 8);
+
+  int expected = 20;
+  while (!(batch = queue.read_batch(shared_cursor)).empty()) {
+    for (int value : batch) {
+      EXPECT_EQ(value, expected++);
+    }
+  }
+  EXPECT_EQ(expected, 30);
+  EXPECT_EQ(shared_cursor.load(), 30u);
+}
+
+TEST(SlickQueueTests, AtomicCursorBatchClaimBeyondDefaultMax) {
+  SlickQueue<int> queue(512);
+  std::atomic<uint64_t> shared_cursor{0};
+  for (int i = 0; i < 300; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+
+  // a larger max is honoured in full, not cut at the default batch size
+  auto batch = queue.read_batch(shared_cursor, 200);
+  ASSERT_EQ(batch.size(), 200u);
+  EXPECT_EQ(batch[199], 199);
+
+  // a short run longer than the default is still split in half
+  batch = queue.read_batch(shared_cursor, 200);
+  ASSERT_EQ(batch.size(), 51u);
+  EXPECT_EQ(batch[0], 200);
+  EXPECT_EQ(shared_cursor.load(), 251u);
+}
+
+TEST(SlickQueueTests, AtomicCursorBatchClaimWorkStealing) {
+  SlickQueue<int> queue(1024);
+  std::atomic<uint64_t> shared_cursor{0};
+  std::atomic<int> total_consumed{0};
+  std::atomic<int64_t> sum{0};
+  constexpr int kItems = 1000;
+
+  std::thread producer([&]() {
+    for (int i = 0; i < kItems; ++i) {
+      auto slot = queue.reserve();
+      *queue[slot] = i;
+      queue.publish(slot);
+    }
+  });
+
+  auto consumer = [&]() {
+    while (total_consumed.load() < kItems) {
+      auto batch = queue.read_batch(shared_cursor);
+      for (int value : batch) {
+        sum.fetch_add(value);
+      }
+      total_consumed.fetch_add(static_cast<int>(batch.size()));
+      if (batch.empty()) {
+        std::this_thread::yield();
+      }
+    }
+  };
+  std::thread consumers[3] = { std::thread(consumer), std::thread(consumer), std::thread(consumer) };
+
+  producer.join();
+  for (auto& c : consumers) {
+    c.join();
+  }
+  EXPECT_EQ(total_consumed.load(), kItems);
+  EXPECT_EQ(sum.load(), static_cast<int64_t>(kItems) * (kItems - 1) / 2);
+  EXPECT_EQ(shared_cursor.load(), static_cast<uint64_t>(kItems));
+}
+
+TEST(SlickQueueTests, ReaderRewindsAfterReset) {
+  SlickQueue<int> queue(8);
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 6; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+  while (queue.read(read_cursor).first) {}
+  EXPECT_EQ(read_cursor, 6u);
+
+  queue.reset();
+  auto slot = queue.reserve();
+  EXPECT_EQ(slot, 0u);
+  *queue[slot] = 42;
+  queue.publish(slot);
+
+  auto read = queue.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+  EXPECT_EQ(read_cursor, 1u);
+}
+
+TEST(SlickQueueTests, EveryStrandedCursorRewindsAfterReset) {
+  SlickQueue<int> queue(8);
+  auto produce = [&](int count) {
+    for (int i = 0; i < count; ++i) {
+      auto slot = queue.reserve();
+      *queue[slot] = i;
+      queue.publish(slot);
+    }
+  };
+  produce(6);
+  uint64_t ahead = 6;
+  uint64_t behind = 3;
+
+  for (int round = 0; round < 2; ++round) {
+    queue.reset();
+    produce(2);
+    // both cursors of this instance are past the new reservation point
+    for (auto* cursor : { &ahead, &behind }) {
+      auto read = queue.read(*cursor);
+      ASSERT_NE(read.first, nullptr);
+      EXPECT_EQ(*read.first, 0);
+      EXPECT_NE(queue.read(*cursor).first, nullptr);
+      // caught up, an empty poll leaves the cursor where it is
+      EXPECT_EQ(queue.read(*cursor).first, nullptr);
+      EXPECT_EQ(*cursor, 2u);
+    }
+    produce(1);
+    EXPECT_NE(queue.read(ahead).first, nullptr);
+    EXPECT_EQ(ahead, 3u);
+    behind = 3;
+  }
+}
+
+TEST(SlickQueueTests, SharedCursorRewindsAfterReset) {
+  SlickQueue<int> queue(8);
+  std::atomic<uint64_t> read_cursor{ 0 };
+  for (int i = 0; i < 3; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+  EXPECT_EQ(queue.read_batch(read_cursor).size(), 2u);
+  EXPECT_EQ(queue.read_batch(read_cursor).size(), 1u);
+  EXPECT_EQ(queue.read(read_cursor).first, nullptr);
+
+  queue.reset();
+  EXPECT_EQ(queue.read(read_cursor).first, nullptr);
+  EXPECT_EQ(read_cursor.load(), 0u);
+
+  auto slot = queue.reserve();
+  *queue[slot] = 42;
+  queue.publish(slot);
+  auto read = queue.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 42);
+}
+
+template<typename Wait>
+void expect_read_wait_times_out() {
+  SlickQueue<int> queue(4);
+  uint64_t read_cursor = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto read = queue.read_wait<Wait>(read_cursor, std::chrono::milliseconds(20));
+  EXPECT_EQ(read.first, nullptr);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+  EXPECT_EQ(read_cursor, 0u);
+}
+
+TEST(SlickQueueTests, ReadWaitTimesOut) {
+  expect_read_wait_times_out<busy_spin_wait>();
+  expect_read_wait_times_out<relax_wait>();
+  expect_read_wait_times_out<yield_wait>();
+  expect_read_wait_times_out<sleep_wait>();
+  expect_read_wait_times_out<blocking_wait>();
+}
+
+TEST(SlickQueueTests, ReadWaitReturnsReadyDataImmediately) {
+  SlickQueue<int> queue(4);
+  auto slot = queue.reserve();
+  *queue[slot] = 7;
+  queue.publish(slot);
+  uint64_t read_cursor = 0;
+  auto read = queue.read_wait<blocking_wait>(read_cursor, std::chrono::seconds(0));
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 7);
+  EXPECT_EQ(read_cursor, 1u);
+}
+
+TEST(SlickQueueTests, BlockingWaitWakesOnPublish) {
+  SlickQueue<int> queue(16);
+  std::atomic<int> received{ -1 };
+  std::thread consumer([&]() {
+    uint64_t read_cursor = 0;
+    auto read = queue.read_wait<blocking_wait>(read_cursor, std::chrono::seconds(10));
+    if (read.first) {
+      received = *read.first;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto start = std::chrono::steady_clock::now();
+  auto slot = queue.reserve();
+  *queue[slot] = 42;
+  queue.publish(slot);
+  consumer.join();
+  EXPECT_EQ(received.load(), 42);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(SlickQueueTests, BlockingWaitDoesNotMissPublishRacingSleep) {
+  // publishes land around the moment the consumer stops spinning and goes to sleep; without
+  // a wake-up the consumer would sleep until its timeout
+  SlickQueue<int> queue(64);
+  uint64_t read_cursor = 0;
+  for (int round = 0; round < 200; ++round) {
+    std::thread producer([&]() {
+      auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(round % 40);
+      while (std::chrono::steady_clock::now() < until) {
+      }
+      auto slot = queue.reserve();
+      *queue[slot] = round;
+      queue.publish(slot);
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto read = queue.read_wait<blocking_wait>(read_cursor, std::chrono::hours::max());
+    producer.join();
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, round);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5)) << "round " << round;
+  }
+}
+
+TEST(SlickQueueTests, WaitForCountsReadyEntries) {
+  SlickQueue<int> queue(8);
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 2; ++i) {
+    auto slot = queue.reserve();
+    queue.publish(slot);
+  }
+  auto soon = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+  EXPECT_TRUE(queue.wait_for(read_cursor, 2, soon));
+  EXPECT_FALSE(queue.wait_for<blocking_wait>(read_cursor, 3, soon));
+
+  std::thread producer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto slot = queue.reserve(2);
+    queue.publish(slot, 2);
+  });
+  EXPECT_TRUE(queue.wait_for<blocking_wait>(read_cursor, 3, std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+  producer.join();
+  EXPECT_EQ(read_cursor, 0u);
+}
+
+struct counting_wait {
+  static inline uint32_t calls = 0;
+  static void idle(uint32_t spins) noexcept {
+    EXPECT_EQ(spins, calls);
+    ++calls;
+  }
+};
+
+TEST(SlickQueueTests, CustomWaitStrategy) {
+  SlickQueue<int> queue(4);
+  uint64_t read_cursor = 0;
+  auto read = queue.read_wait<counting_wait>(read_cursor, std::chrono::milliseconds(5));
+  EXPECT_EQ(read.first, nullptr);
+  EXPECT_GT(counting_wait::calls, 0u);
+}
+
+#if defined(__linux__)
+#include <poll.h>
+
+static bool fd_readable(int fd, int timeout_ms) {
+  pollfd pfd{ fd, POLLIN, 0 };
+  return ::poll(&pfd, 1, timeout_ms) == 1 && (pfd.revents & POLLIN);
+}
+
+TEST(SlickQueueTests, NotifierSignalsOnlyWhenArmed) {
+  SlickQueue<int> queue(8);
+  uint64_t read_cursor = 0;
+  int fd = queue.notifier();
+  ASSERT_GE(fd, 0);
+  EXPECT_EQ(queue.notifier(), fd);
+
+  auto slot = queue.reserve();
+  queue.publish(slot);
+  EXPECT_FALSE(fd_readable(fd, 0));
+  EXPECT_FALSE(queue.arm_notifier(read_cursor));  // data already ready
+  ASSERT_NE(queue.read(read_cursor).first, nullptr);
+  queue.drain_notifier();
+
+  EXPECT_TRUE(queue.arm_notifier(read_cursor));
+  EXPECT_FALSE(fd_readable(fd, 0));
+  slot = queue.reserve();
+  queue.publish(slot);
+  EXPECT_TRUE(fd_readable(fd, 0));
+  queue.drain_notifier();
+  EXPECT_FALSE(fd_readable(fd, 0));
+
+  // one signal per arming
+  ASSERT_NE(queue.read(read_cursor).first, nullptr);
+  slot = queue.reserve();
+  queue.publish(slot);
+  EXPECT_FALSE(fd_readable(fd, 0));
+}
+
+TEST(SlickQueueTests, NotifierWakesPollingConsumer) {
+  SlickQueue<int> queue(16);
+  int fd = queue.notifier();
+  std::atomic<int> received{ -1 };
+  std::thread consumer([&]() {
+    uint64_t read_cursor = 0;
+    while (queue.arm_notifier(read_cursor)) {
+      fd_readable(fd, 10000);
+      queue.drain_notifier();
+    }
+    auto read = queue.read(read_cursor);
+    if (read.first) {
+      received = *read.first;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  auto slot = queue.reserve();
+  *queue[slot] = 42;
+  queue.publish(slot);
+  consumer.join();
+  EXPECT_EQ(received.load(), 42);
+}
+#endif
+
+// Fire-and-forget coroutine, enough to drive the queue awaitables
+struct detached_task {
+  struct promise_type {
+    detached_task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+struct manual_scheduler {
+  std::vector<std::coroutine_handle<>> ready;
+  void schedule(std::coroutine_handle<> handle) noexcept { ready.push_back(handle); }
+  size_t run() {
+    auto batch = std::move(ready);
+    ready.clear();
+    for (auto handle : batch) {
+      handle.resume();
+    }
+    return batch.size();
+  }
+};
+
+detached_task consume(SlickQueue<int>& queue, uint64_t& cursor, int count, std::vector<int>& out) {
+  for (int i = 0; i < count; ++i) {
+    auto [data, size] = co_await queue.async_read(cursor);
+    out.push_back(data ? *data : -1);
+  }
+}
+
+TEST(SlickQueueTests, AsyncReadResumesOnResumeReady) {
+  SlickQueue<int> queue(8);
+  uint64_t cursor = 0;
+  std::vector<int> out;
+  auto slot = queue.reserve();
+  *queue[slot] = 1;
+  queue.publish(slot);
+
+  consume(queue, cursor, 3, out);
+  ASSERT_EQ(out.size(), 1u);  // ready data does not suspend
+  EXPECT_EQ(out[0], 1);
+
+  EXPECT_EQ(queue.resume_ready(), 0u);  // nothing published yet
+  for (int i = 2; i <= 3; ++i) {
+    slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+    // publish() never runs the coroutine on the producing thread
+    ASSERT_EQ(out.size(), static_cast<size_t>(i - 1));
+    EXPECT_EQ(queue.resume_ready(), 1u);
+    ASSERT_EQ(out.size(), static_cast<size_t>(i));
+    EXPECT_EQ(out.back(), i);
+  }
+  EXPECT_EQ(cursor, 3u);
+}
+
+detached_task consume_scheduled(SlickQueue<int>& queue, manual_scheduler& scheduler, uint64_t& cursor, int count, int& sum) {
+  for (int i = 0; i < count; ++i) {
+    auto [data, size] = co_await queue.async_read(cursor, scheduler);
+    sum += *data;
+  }
+}
+
+TEST(SlickQueueTests, AsyncReadMultiplexesConsumersOnScheduler) {
+  constexpr int kConsumers = 200;
+  constexpr int kItems = 50;
+  SlickQueue<int> queue(64);
+  manual_scheduler scheduler;
+  std::vector<uint64_t> cursors(kConsumers, 0);
+  std::vector<int> sums(kConsumers, 0);
+  for (int c = 0; c < kConsumers; ++c) {
+    consume_scheduled(queue, scheduler, cursors[c], kItems, sums[c]);
+  }
+
+  for (int i = 1; i <= kItems; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+    // publish() only hands the coroutines to the scheduler, which runs them all on this thread
+    ASSERT_EQ(scheduler.ready.size(), static_cast<size_t>(kConsumers));
+    EXPECT_EQ(sums[0], i * (i - 1) / 2);
+    scheduler.run();
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    EXPECT_EQ(cursors[c], static_cast<uint64_t>(kItems));
+    EXPECT_EQ(sums[c], kItems * (kItems + 1) / 2);
+  }
+}
+
+detached_task consume_batches(SlickQueue<int>& queue, uint64_t& cursor, int total, std::vector<size_t>& batches) {
+  for (int received = 0; received < total;) {
+    auto batch = co_await queue.async_read_batch(cursor);
+    batches.push_back(batch.size());
+    received += static_cast<int>(batch.size());
+  }
+}
+
+TEST(SlickQueueTests, AsyncReadBatchSuspendsUntilData) {
+  SlickQueue<int> queue(16);
+  uint64_t cursor = 0;
+  std::vector<size_t> batches;
+  for (int i = 0; i < 3; ++i) {
+    auto slot = queue.reserve();
+    queue.publish(slot);
+  }
+  consume_batches(queue, cursor, 4, batches);
+  ASSERT_EQ(batches.size(), 1u);
+  EXPECT_EQ(batches[0], 3u);
+
+  auto slot = queue.reserve();
+  queue.publish(slot);
+  EXPECT_EQ(batches.size(), 1u);
+  queue.resume_ready();
+  ASSERT_EQ(batches.size(), 2u);
+  EXPECT_EQ(batches[1], 1u);
+}
+
+struct locked_scheduler {
+  std::mutex mutex;
+  std::vector<std::coroutine_handle<>> ready;
+  void schedule(std::coroutine_handle<> handle) noexcept {
+    std::lock_guard lock(mutex);
+    ready.push_back(handle);
+  }
+  void run() {
+    std::vector<std::coroutine_handle<>> batch;
+    {
+      std::lock_guard lock(mutex);
+      batch.swap(ready);
+    }
+    for (auto handle : batch) {
+      handle.resume();
+    }
+  }
+};
+
+detached_task consume_locked(SlickQueue<int>& queue, locked_scheduler& scheduler, uint64_t& cursor, int count, std::atomic<int>& sum) {
+  for (int i = 0; i < count; ++i) {
+    auto [data, size] = co_await queue.async_read(cursor, scheduler);
+    sum += *data;
+  }
+}
+
+TEST(SlickQueueTests, AsyncReadWithProducerThread) {
+  constexpr int kConsumers = 20;
+  constexpr int kItems = 500;
+  SlickQueue<int> queue(1024);
+  locked_scheduler scheduler;
+  std::vector<uint64_t> cursors(kConsumers, 0);
+  std::vector<std::atomic<int>> sums(kConsumers);
+  for (int c = 0; c < kConsumers; ++c) {
+    consume_locked(queue, scheduler, cursors[c], kItems, sums[c]);
+  }
+  std::thread producer([&]() {
+    for (int i = 1; i <= kItems; ++i) {
+      auto slot = queue.reserve();
+      *queue[slot] = i;
+      queue.publish(slot);
+      if (i % 50 == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+  auto all_done = [&]() {
+    for (auto& sum : sums) {
+      if (sum.load() != kItems * (kItems + 1) / 2) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (!all_done() && std::chrono::steady_clock::now() < deadline) {
+    scheduler.run();
+    std::this_thread::yield();
+  }
+  producer.join();
+  EXPECT_TRUE(all_done());
+}
+
+TEST(SlickQueueTests, AsyncReadFirstSuspendRacesPublish) {
+  // the first await on a fresh queue races a publish from another thread: the coroutine either
+  // sees the entry while suspending or is handed to the scheduler, it never stays suspended
+  for (int round = 0; round < 2000; ++round) {
+    SlickQueue<int> queue(8);
+    locked_scheduler scheduler;
+    uint64_t cursor = 0;
+    std::atomic<int> sum{ 0 };
+    std::atomic<bool> go{ false };
+    std::thread producer([&]() {
+      while (!go.load(std::memory_order_acquire)) {
+      }
+      auto slot = queue.reserve();
+      *queue[slot] = 1;
+      queue.publish(slot);
+    });
+    go.store(true, std::memory_order_release);
+    consume_locked(queue, scheduler, cursor, 1, sum);
+    producer.join();
+    scheduler.run();
+    ASSERT_EQ(sum.load(), 1) << "round " << round;
+  }
+}
+
+TEST(SlickQueueTests, ProducerHandleClaimsBlocks) {
+  SlickQueue<int> queue(16);
+  auto producer = queue.make_producer(4);
+  for (int i = 0; i < 3; ++i) {
+    auto slot = producer.reserve();
+    EXPECT_EQ(slot, static_cast<uint64_t>(i));
+    *producer[slot] = i;
+    producer.publish(slot);
+  }
+  // the whole block is claimed, a regular reserve() starts after it
+  EXPECT_EQ(queue.reserve(), 4u);
+
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 3; ++i) {
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(queue.read(read_cursor).first, nullptr);
+
+  producer.flush();
+  *queue[4] = 40;
+  queue.publish(4);
+  auto read = queue.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(*read.first, 40);
+  EXPECT_EQ(read_cursor, 5u);
+}
+
+TEST(SlickQueueTests, ProducerHandleFlushesOnDestruction) {
+  SlickQueue<int> queue(16);
+  {
+    auto producer = queue.make_producer(8);
+    auto slot = producer.reserve();
+    *producer[slot] = 1;
+    producer.publish(slot);
+  }
+  auto slot = queue.reserve();
+  *queue[slot] = 2;
+  queue.publish(slot);
+
+  uint64_t read_cursor = 0;
+  EXPECT_EQ(*queue.read(read_cursor).first, 1);
+  EXPECT_EQ(*queue.read(read_cursor).first, 2);
+  EXPECT_EQ(read_cursor, 9u);
+}
+
+TEST(SlickQueueTests, ProducerHandleInvalidBlockThrows) {
+  SlickQueue<int> queue(8);
+  EXPECT_THROW(queue.make_producer(0), std::invalid_argument);
+  EXPECT_THROW(queue.make_producer(8), std::invalid_argument);
+}
+
+TEST(SlickQueueTests, ProducerHandlesFromManyThreads) {
+  constexpr int kProducers = 4;
+  constexpr int kItems = 2000;
+  SlickQueue<int> queue(1u << 15);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p]() {
+      auto producer = queue.make_producer(16);
+      for (int i = 0; i < kItems; ++i) {
+        auto slot = producer.reserve();
+        *producer[slot] = p * kItems + i;
+        producer.publish(slot);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::vector<int> seen(kProducers * kItems, 0);
+  uint64_t read_cursor = 0;
+  for (auto read = queue.read(read_cursor); read.first; read = queue.read(read_cursor)) {
+    ++seen[*read.first];
+  }
+  for (int count : seen) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+TEST(SlickQueueTests, ProducerHandleWithInterleavedLayout) {
+  SlickQueue<int> queue(8, queue_options{ .layout = queue_layout::interleaved });
+  auto producer = queue.make_producer(3);
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 10; ++i) {
+    auto slot = producer.reserve();
+    *producer[slot] = i;
+    producer.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+}
+
+TEST(SlickQueueTests, PublishRangeMakesSingleEntries) {
+  SlickQueue<int> queue(8);
+  auto first = queue.reserve(4);
+  for (int i = 0; i < 4; ++i) {
+    *queue[first + i] = i;
+  }
+  queue.publish_range(first, 4);
+  EXPECT_EQ(*queue.read_last().first, 3);
+
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 4; ++i) {
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(read.second, 1u);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(queue.read(read_cursor).first, nullptr);
+}
+
+TEST(SlickQueueTests, ScatterPublish) {
+  SlickQueue<int> queue(8);
+  std::vector<uint64_t> slots;
+  for (int i = 0; i < 3; ++i) {
+    slots.push_back(queue.reserve());
+    *queue[slots.back()] = i * 10;
+  }
+  uint64_t read_cursor = 0;
+  std::vector<uint64_t> later{ slots[2], slots[1] };
+  queue.publish(std::span<const uint64_t>(later));
+  EXPECT_EQ(queue.read(read_cursor).first, nullptr);  // slot 0 still pending
+  EXPECT_EQ(*queue.read_last().first, 20);
+
+  queue.publish(std::span<const uint64_t>(slots.data(), 1));
+  for (int i = 0; i < 3; ++i) {
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i * 10);
+  }
+}
+
+TEST(SlickQueueTests, PublishRangeSingleProducer) {
+  SlickQueue<int, single_producer> queue(16);
+  auto first = queue.reserve(5);
+  for (int i = 0; i < 5; ++i) {
+    *queue[first + i] = i;
+  }
+  queue.publish_range(first, 5);
+  uint64_t read_cursor = 0;
+  EXPECT_EQ(queue.read_batch(read_cursor).size(), 5u);
+  EXPECT_EQ(*queue.read_last().first, 4);
+}
+
+#if defined(__linux__)
+TEST(SlickQueueTests, MirroredReservationIsContiguousAcrossTheEnd) {
+  SlickQueue<int> queue(1024, queue_options{ .mirrored = true });
+  EXPECT_TRUE(queue.mirrored());
+  auto warmup = queue.reserve(1000);
+  queue.publish(warmup, 1000);
+
+  // the second reservation straddles the physical end without skipping to slot 0
+  auto slot = queue.reserve(100);
+  EXPECT_EQ(slot, 1000u);
+  for (int i = 0; i < 100; ++i) {
+    queue[slot][i] = i;
+  }
+  queue.publish(slot, 100);
+
+  uint64_t read_cursor = 1000;
+  auto read = queue.read(read_cursor);
+  ASSERT_NE(read.first, nullptr);
+  EXPECT_EQ(read.second, 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(read.first[i], i);
+  }
+  EXPECT_EQ(read_cursor, 1100u);
+  // the tail written past the end aliases the start of the ring
+  EXPECT_EQ(*queue[1024], 24);
+  EXPECT_EQ(queue[1024], queue[0]);
+}
+
+TEST(SlickQueueTests, MirroredBatchCrossesTheEnd) {
+  SlickQueue<int, single_producer> queue(1024, queue_options{ .mirrored = true });
+  for (int i = 0; i < 1030; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+  uint64_t read_cursor = 1020;
+  auto batch = queue.read_batch(read_cursor);
+  ASSERT_EQ(batch.size(), 10u);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(batch[i], 1020 + i);
+  }
+}
+
+TEST(SlickQueueTests, MirroredRejectsInvalidOptions) {
+  EXPECT_THROW((SlickQueue<int>(16, queue_options{ .mirrored = true })), std::invalid_argument);
+  EXPECT_THROW((SlickQueue<int>(1024, queue_options{ .layout = queue_layout::interleaved, .mirrored = true })),
+    std::invalid_argument);
+}
+#endif
+
+TEST(SlickQueueTests, HugePagesReportBacking) {
+  SlickQueue<int> plain(1024);
+  EXPECT_EQ(plain.backing(), page_backing::base);
+  const queue_options variants[] = {
+    { .huge_pages = true },
+    { .layout = queue_layout::interleaved, .huge_pages = true },
+    { .mirrored = true, .huge_pages = true },
+  };
+  for (auto& options : variants) {
+    SlickQueue<int> queue(1024, options);
+    // falls back to transparent huge pages or base pages when the hugetlb pool is empty
+    if (queue.backing() == page_backing::huge) {
+      EXPECT_GT(queue.page_size(), plain.page_size());
+    } else {
+      EXPECT_EQ(queue.page_size(), plain.page_size());
+    }
+    uint64_t read_cursor = 0;
+    for (int i = 0; i < 3000; ++i) {
+      auto slot = queue.reserve();
+      *queue[slot] = i;
+      queue.publish(slot);
+      auto read = queue.read(read_cursor);
+      ASSERT_NE(read.first, nullptr);
+      EXPECT_EQ(*read.first, i);
+    }
+  }
+}
+
+#if defined(__linux__)
+TEST(SlickQueueTests, NumaPlacement) {
+  const queue_options variants[] = {
+    { .numa = numa_policy::preferred, .numa_node = 0 },
+    { .numa = numa_policy::bind, .numa_node = 0 },
+    { .numa = numa_policy::interleave },
+    { .mirrored = true, .numa = numa_policy::bind, .numa_node = 0 },
+  };
+  for (auto& options : variants) {
+    SlickQueue<uint64_t> queue(1u << 14, options);
+    auto placement = queue.numa_placement();
+    ASSERT_FALSE(placement.empty());
+    std::size_t pages = 0;
+    for (auto count : placement) {
+      pages += count;
+    }
+    // the constructor touched the 256 KB control array, the 128 KB data array of a trivial T
+    // is left to the first publish
+    EXPECT_GE(pages, 16 * (1u << 14) / 4096);
+    EXPECT_LT(pages, (sizeof(uint64_t) + 16) * (1u << 14) / 4096);
+    if (options.numa != numa_policy::interleave) {
+      EXPECT_EQ(placement[0], pages);
+    }
+  }
+  EXPECT_THROW((SlickQueue<int>(16, queue_options{ .numa = numa_policy::bind, .numa_node = 4000 })), std::invalid_argument);
+}
+#endif
+
+TEST(SlickQueueTests, WarmUpPrefaultsAndLocks) {
+  SlickQueue<int> plain(1024);
+  EXPECT_FALSE(plain.locked());
+  EXPECT_EQ(plain.warm_up_time().count(), 0);
+
+  const queue_options variants[] = {
+    { .warm_up = { .prefault = true, .threads = 4 } },
+    { .layout = queue_layout::interleaved, .warm_up = { .prefault = true, .lock = true } },
+#if defined(__linux__)
+    { .mirrored = true, .warm_up = { .prefault = true, .lock = true, .threads = 2 } },
+#endif
+  };
+  for (auto& options : variants) {
+    SlickQueue<int> queue(1u << 16, options);
+    EXPECT_GT(queue.warm_up_time().count(), 0);
+    // prefault must not disturb constructed slots
+    uint64_t read_cursor = 0;
+    EXPECT_EQ(queue.read(read_cursor).first, nullptr);
+    auto slot = queue.reserve();
+    *queue[slot] = 5;
+    queue.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, 5);
+  }
+}
+
+namespace {
+struct tracked {
+  static inline int constructed = 0;
+  static inline int destroyed = 0;
+  explicit tracked(int v) : value(v) { ++constructed; }
+  ~tracked() { ++destroyed; }
+  int value;
+};
+}
+
+TEST(SlickQueueTests, UninitializedStorageConstructsOnEmplace) {
+  tracked::constructed = 0;
+  tracked::destroyed = 0;
+  {
+    SlickQueue<tracked> queue(8, queue_options{ .uninitialized = true });
+    EXPECT_TRUE(queue.uninitialized());
+    EXPECT_EQ(tracked::constructed, 0);
+    uint64_t read_cursor = 0;
+    for (int i = 0; i < 20; ++i) {
+      auto slot = queue.reserve();
+      queue.emplace(slot, i);
+      queue.publish(slot);
+      auto read = queue.read(read_cursor);
+      ASSERT_NE(read.first, nullptr);
+      EXPECT_EQ(read.first->value, i);
+    }
+    EXPECT_EQ(tracked::constructed, 20);
+    EXPECT_EQ(tracked::destroyed, 12);  // the first two laps were overwritten
+  }
+  EXPECT_EQ(tracked::destroyed, 20);
+  EXPECT_THROW(SlickQueue<tracked>(8), std::invalid_argument);
+}
+
+TEST(SlickQueueTests, EmplaceReplacesDefaultConstructedElements) {
+  SlickQueue<std::string> queue(4);
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 10; ++i) {
+    auto slot = queue.reserve();
+    queue.emplace(slot, 40, static_cast<char>('a' + i));
+    queue.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, std::string(40, static_cast<char>('a' + i)));
+  }
+
+  SlickQueue<uint64_t> raw(1024, queue_options{ .layout = queue_layout::interleaved, .uninitialized = true });
+  auto slot = raw.reserve();
+  EXPECT_EQ(*raw.emplace(slot, 7u), 7u);
+  raw.publish(slot);
+  EXPECT_EQ(*raw.read_last().first, 7u);
+}
+
+TEST(SlickQueueTests, ValueInSlotPublishAndRead) {
+  SlickQueue<uint64_t, value_in_slot> queue(8);
+  EXPECT_EQ(queue.layout(), queue_layout::packed);
+  // the element lives in its 16-byte control slot
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(queue[1]) - reinterpret_cast<uintptr_t>(queue[0]), 16u);
+  uint64_t read_cursor = 0;
+  for (uint64_t i = 0; i < 20; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i * 1000 + 7;
+    queue.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i * 1000 + 7);
+    EXPECT_EQ(read.second, 1u);
+  }
+  EXPECT_EQ(read_cursor, 20u);
+  EXPECT_EQ(*queue.read_last().first, 19007u);
+  EXPECT_EQ(queue.read_last().second, 1u);
+}
+
+TEST(SlickQueueTests, ValueInSlotSlotMappings) {
+  for (auto mapping : { slot_mapping::linear, slot_mapping::padded, slot_mapping::swizzled }) {
+    SlickQueue<int32_t, value_in_slot, single_producer> queue(16, queue_options{ .mapping = mapping,
+      .track_last_published = false });
+    uint64_t read_cursor = 0;
+    int32_t expected = 0;
+    for (int round = 0; round < 5; ++round) {
+      auto first = queue.reserve(1);
+      *queue[first] = round * 10;
+      auto second = queue.reserve(1);
+      *queue[second] = round * 10 + 1;
+      queue.publish_range(first, 2);
+      auto handled = queue.poll(read_cursor, [&](int32_t* data, uint32_t size) {
+        EXPECT_EQ(size, 1u);
+        EXPECT_EQ(*data, (expected / 2) * 10 + expected % 2);
+        ++expected;
+      });
+      EXPECT_EQ(handled, 2u);
+    }
+    EXPECT_EQ(*queue.read_last().first, 41);
+  }
+}
+
+TEST(SlickQueueTests, ValueInSlotSharedCursor) {
+  SlickQueue<uint32_t, value_in_slot> queue(64);
+  for (uint32_t i = 0; i < 10; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+  }
+  std::atomic<uint64_t> shared_cursor{ 0 };
+  auto batch = queue.read_batch(shared_cursor, 8);
+  ASSERT_EQ(batch.size(), 1u);
+  EXPECT_EQ(batch[0], 0u);
+  for (uint32_t i = 1; i < 10; ++i) {
+    auto read = queue.read(shared_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(queue.read(shared_cursor).first, nullptr);
+}
+
+TEST(SlickQueueTests, ValueInSlotRejectsOtherLayouts) {
+  SlickQueue<uint64_t, value_in_slot> queue(8);
+  EXPECT_THROW(queue.reserve(2), std::invalid_argument);
+  EXPECT_THROW((SlickQueue<uint64_t, value_in_slot>(8, queue_options{ .layout = queue_layout::interleaved })),
+    std::invalid_argument);
+  EXPECT_THROW((SlickQueue<uint64_t>(8, queue_options{ .layout = queue_layout::packed })), std::invalid_argument);
+#if defined(__linux__)
+  EXPECT_THROW((SlickQueue<uint64_t, value_in_slot>(1024, queue_options{ .mirrored = true })), std::invalid_argument);
+#endif
+}
+
+TEST(SlickQueueTests, CompactSlotsPublishAndRead) {
+  for (auto mapping : { slot_mapping::linear, slot_mapping::padded, slot_mapping::swizzled }) {
+    SlickQueue<char, compact_slots> queue(16, queue_options{ .mapping = mapping });
+    EXPECT_TRUE(queue.compact_slots());
+    uint64_t read_cursor = 0;
+    // 5-slot entries leave a wrap marker at the end of every lap
+    for (uint64_t expected : { 0, 5, 10, 16, 21, 26, 32 }) {
+      auto reserved = queue.reserve(5);
+      EXPECT_EQ(reserved, expected);
+      memcpy(queue[reserved], "hello", 5);
+      queue.publish(reserved, 5);
+      auto read = queue.read(read_cursor);
+      ASSERT_NE(read.first, nullptr);
+      EXPECT_EQ(read.second, 5u);
+      EXPECT_EQ(strncmp(read.first, "hello", 5), 0);
+      EXPECT_EQ(read_cursor, expected + 5);
+    }
+    EXPECT_EQ(queue.read(read_cursor).first, nullptr);
+    EXPECT_EQ(queue.read_last().second, 5u);
+  }
+}
+
+TEST(SlickQueueTests, CompactSlotsBatchesAndSharedCursor) {
+  SlickQueue<int, compact_slots> queue(64, queue_options{ .track_last_published = false });
+  auto first = queue.reserve(8);
+  for (int i = 0; i < 8; ++i) {
+    *queue[first + i] = i;
+  }
+  queue.publish_range(first, 8);
+  uint64_t indices[] = { queue.reserve(), queue.reserve() };
+  *queue[indices[0]] = 8;
+  *queue[indices[1]] = 9;
+  queue.publish(std::span<const uint64_t>(indices));
+  EXPECT_EQ(*queue.read_last().first, 9);
+
+  uint64_t read_cursor = 0;
+  auto batch = queue.read_batch(read_cursor, 6);
+  ASSERT_EQ(batch.size(), 6u);
+  EXPECT_EQ(batch[5], 5);
+  int expected = 6;
+  EXPECT_EQ(queue.poll(read_cursor, [&](int* data, uint32_t size) {
+    EXPECT_EQ(size, 1u);
+    EXPECT_EQ(*data, expected++);
+  }), 4u);
+
+  // a short run of 10 ready slots is halved for other consumers
+  std::atomic<uint64_t> shared_cursor{ 0 };
+  EXPECT_EQ(queue.read_batch(shared_cursor, 64).size(), 6u);
+  EXPECT_EQ(queue.read_batch(shared_cursor, 64).size(), 3u);
+  EXPECT_EQ(*queue.read(shared_cursor).first, 9);
+  EXPECT_EQ(queue.read(shared_cursor).first, nullptr);
+}
+
+TEST(SlickQueueTests, CompactSlotsProducerHandleFlush) {
+  SlickQueue<int, compact_slots> queue(16);
+  {
+    auto producer = queue.make_producer(8);
+    auto slot = producer.reserve();
+    *producer[slot] = 1;
+    producer.publish(slot);
+  }
+  auto slot = queue.reserve();
+  *queue[slot] = 2;
+  queue.publish(slot);
+
+  uint64_t read_cursor = 0;
+  EXPECT_EQ(*queue.read(read_cursor).first, 1);
+  EXPECT_EQ(*queue.read(read_cursor).first, 2);
+  EXPECT_EQ(read_cursor, 9u);
+}
+
+TEST(SlickQueueTests, CompactSlotsRejectsUnsupportedOptions) {
+  EXPECT_THROW((SlickQueue<int, compact_slots>(8, queue_options{ .layout = queue_layout::interleaved })),
+    std::invalid_argument);
+  SlickQueue<char, compact_slots> queue(1 << 17);
+  EXPECT_THROW(queue.reserve(1 << 16), std::invalid_argument);
+  EXPECT_NO_THROW(queue.reserve(0xFFFF));
+  EXPECT_THROW(queue.make_producer(1 << 16), std::invalid_argument);
+  EXPECT_NO_THROW(queue.make_producer(0xFFFF));
+}
+
+TEST(SlickQueueTests, StaticCapacityPublishAndRead) {
+  SlickQueue<char, static_capacity<8>> queue;
+  EXPECT_EQ(queue.size(), 8u);
+  uint64_t read_cursor = 0;
+  for (uint64_t expected : { 0, 3, 8, 11, 16 }) {
+    auto reserved = queue.reserve(3);
+    EXPECT_EQ(reserved, expected);
+    memcpy(queue[reserved], "xyz", 3);
+    queue.publish(reserved, 3);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(read.second, 3u);
+    EXPECT_EQ(strncmp(read.first, "xyz", 3), 0);
+    EXPECT_EQ(read_cursor, expected + 3);
+  }
+  EXPECT_THROW(queue.reserve(9), std::runtime_error);
+}
+
+TEST(SlickQueueTests, StaticCapacityWithOtherPolicies) {
+  SlickQueue<uint64_t, single_producer, static_capacity<16>, value_in_slot> queue(queue_options{ .mapping = slot_mapping::swizzled });
+  EXPECT_EQ(queue.layout(), queue_layout::packed);
+  uint64_t read_cursor = 0;
+  for (uint64_t i = 0; i < 40; ++i) {
+    auto slot = queue.reserve();
+    *queue[slot] = i;
+    queue.publish(slot);
+    auto read = queue.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+  EXPECT_EQ(*queue.read_last().first, 39u);
+}
+
+TEST(SlickQueueTests, StaticCapacityRejectsOtherSizes) {
+  EXPECT_THROW((SlickQueue<int, static_capacity<16>>(32)), std::invalid_argument);
+  EXPECT_NO_THROW((SlickQueue<int, static_capacity<16>, compact_slots>(16)));
+}
+
+TEST(SlickQueueTests, ArraysAreCacheLineAligned) {
+  for (uint32_t size : { 2u, 4u, 64u }) {
+    SlickQueue<char> queue(size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(queue[0]) % 64, 0u);
+    SlickQueue<char, compact_slots> compact(size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(compact[0]) % 64, 0u);
+  }
+}
+
+TEST(SlickQueueTests, CallerBufferBackedQueue) {
+  queue_options options{ .backpressure = true, .max_consumers = 2 };
+  auto bytes = SlickQueue<int>::buffer_size(64, options);
+  EXPECT_GE(bytes, 2 * 128 + 64 * (16 + sizeof(int)));
+  std::vector<std::byte> storage(bytes + SlickQueue<int>::buffer_alignment);
+  auto* aligned = storage.data() + (SlickQueue<int>::buffer_alignment -
+    reinterpret_cast<uintptr_t>(storage.data()) % SlickQueue<int>::buffer_alignment);
+  {
+    SlickQueue<int> queue(64, std::span<std::byte>(aligned, bytes), options);
+    EXPECT_FALSE(queue.own_buffer());
+    auto consumer = queue.register_consumer();
+    auto* first = reinterpret_cast<std::byte*>(queue[0]);
+    EXPECT_GE(first, aligned);
+    EXPECT_LT(first, aligned + bytes);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0u);
+    uint64_t read_cursor = 0;
+    for (int i = 0; i < 100; ++i) {
+      auto slot = queue.reserve();
+      *queue[slot] = i;
+      queue.publish(slot);
+      EXPECT_EQ(*queue.read(read_cursor).first, i);
+      queue.commit(consumer, read_cursor);
+    }
+  }
+
+  EXPECT_THROW((SlickQueue<int>(64, std::span<std::byte>(aligned, bytes - 1), options)), std::invalid_argument);
+  EXPECT_THROW((SlickQueue<int>(64, std::span<std::byte>(aligned + 8, bytes), options)), std::invalid_argument);
+#if defined(__linux__)
+  EXPECT_THROW((SlickQueue<int>(1024, std::span<std::byte>(aligned, bytes), queue_options{ .mirrored = true })),
+    std::invalid_argument);
+#endif
+}
+
+namespace {
+class counting_resource : public std::pmr::memory_resource {
+public:
+  int allocations = 0;
+  int deallocations = 0;
+  std::size_t bytes = 0;
+
+private:
+  void* do_allocate(std::size_t size, std::size_t alignment) override {
+    ++allocations;
+    bytes += size;
+    return std::pmr::new_delete_resource()->allocate(size, alignment);
+  }
+  void do_deallocate(void* p, std::size_t size, std::size_t alignment) override {
+    ++deallocations;
+    std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+}
+
+TEST(SlickQueueTests, MemoryResourceBackedQueue) {
+  counting_resource resource;
+  {
+    queue_options options{ .layout = queue_layout::separate, .uninitialized = true, .memory_resource = &resource };
+    SlickQueue<std::string> queue(16, options);
+    EXPECT_EQ(resource.allocations, 1);
+    EXPECT_EQ(resource.bytes, SlickQueue<std::string>::buffer_size(16, options));
+    uint64_t read_cursor = 0;
+    for (int i = 0; i < 40; ++i) {
+      auto slot = queue.reserve();
+      queue.emplace(slot, 32, static_cast<char>('a' + i % 26));
+      queue.publish(slot);
+      EXPECT_EQ(queue.read(read_cursor).first->size(), 32u);
+    }
+  }
+  EXPECT_EQ(resource.deallocations, 1);
+
+  // every layout fits in a single block
+  std::pmr::monotonic_buffer_resource arena;
+  SlickQueue<int> interleaved(8, queue_options{ .layout = queue_layout::interleaved, .memory_resource = &arena });
+  SlickQueue<uint64_t, value_in_slot> packed(8, queue_options{ .memory_resource = &arena });
+  for (int i = 0; i < 3; ++i) {
+    *interleaved[interleaved.reserve()] = i;
+    interleaved.publish(i);
+    *packed[packed.reserve()] = i;
+    packed.publish(i);
+  }
+  EXPECT_EQ(*interleaved.read_last().first, 2);
+  EXPECT_EQ(*packed.read_last().first, 2u);
+}
+
+namespace {
+struct throws_on_fifth {
+  static inline int constructed = 0;
+  static inline int live = 0;
+  throws_on_fifth() {
+    if (++constructed == 5) {
+      throw std::runtime_error("fifth element");
+    }
+    ++live;
+  }
+  ~throws_on_fifth() { --live; }
+};
+}
+
+TEST(SlickQueueTests, MemoryResourceReleasedWhenElementThrows) {
+  counting_resource resource;
+  EXPECT_THROW((SlickQueue<throws_on_fifth>(8, queue_options{ .memory_resource = &resource })), std::runtime_error);
+  EXPECT_EQ(resource.allocations, 1);
+  EXPECT_EQ(resource.deallocations, 1);
+  EXPECT_EQ(throws_on_fifth::live, 0);
+}
+
+TEST(SlickQueueTests, PrefetchDistanceKeepsResults) {
+  struct large { uint64_t value; char payload[1000]; };
+  SlickQueue<large, single_producer> queue(16, queue_options{ .prefetch_distance = 4 });
+  EXPECT_EQ(queue.prefetch_distance(), 4u);
+  uint64_t poll_cursor = 0;
+  uint64_t batch_cursor = 0;
+  uint64_t expected = 0;
+  for (uint64_t i = 0; i < 64; i += 8) {
+    for (uint64_t j = i; j < i + 8; ++j) {
+      auto slot = queue.reserve();
+      queue[slot]->value = j;
+      queue.publish(slot);
+    }
+    EXPECT_EQ(queue.poll(poll_cursor, [&](large* data, uint32_t) { EXPECT_EQ(data->value, expected++); }), 8u);
+    auto batch = queue.read_batch(batch_cursor);
+    ASSERT_EQ(batch.size(), 8u);
+    EXPECT_EQ(batch.front().value, i);
+  }
+
+  SlickQueue<int> shared(16);
+  shared.set_prefetch_distance(2);
+  auto producer = shared.make_producer(8);
+  for (int i = 0; i < 12; ++i) {
+    auto slot = producer.reserve();
+    *producer[slot] = i;
+    producer.publish(slot);
+  }
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 12; ++i) {
+    auto read = shared.read(read_cursor);
+    ASSERT_NE(read.first, nullptr);
+    EXPECT_EQ(*read.first, i);
+  }
+}
+
+TEST(SlickByteQueueTests, PushAndRead) {
+  SlickByteQueue<> queue(1024);
+  EXPECT_EQ(queue.capacity(), 1024u);
+  const char* messages[] = { "8=FIX.4.4|35=D|", "x", "{\"px\":101.25,\"qty\":300,\"side\":\"buy\",\"venue\":\"XNAS\"}" };
+  for (auto* message : messages) {
+    queue.push(std::as_bytes(std::span(message, std::strlen(message))));
+  }
+  uint64_t read_cursor = 0;
+  for (auto* message : messages) {
+    auto read = queue.read(read_cursor);
+    ASSERT_EQ(read.size(), std::strlen(message));
+    EXPECT_EQ(std::memcmp(read.data(), message, read.size()), 0);
+  }
+  EXPECT_TRUE(queue.read(read_cursor).empty());
+  // 15 + 1 + 51 payload bytes plus headers take a 64-byte chunk each
+  EXPECT_EQ(read_cursor, 3u);
+  EXPECT_EQ(queue.read_last().size(), std::strlen(messages[2]));
+}
+
+TEST(SlickByteQueueTests, ClaimWritesInPlace) {
+  SlickByteQueue<16> queue(256);
+  auto claim = queue.claim(100);
+  ASSERT_EQ(claim.data.size(), 100u);
+  for (std::size_t i = 0; i < claim.data.size(); ++i) {
+    claim.data[i] = static_cast<std::byte>(i);
+  }
+  uint64_t read_cursor = 0;
+  EXPECT_TRUE(queue.read(read_cursor).empty());
+  queue.commit(claim);
+  auto read = queue.read(read_cursor);
+  ASSERT_EQ(read.size(), 100u);
+  EXPECT_EQ(read.data(), claim.data.data());
+  EXPECT_EQ(read[99], static_cast<std::byte>(99));
+  EXPECT_EQ(read_cursor, 7u);
+}
+
+TEST(SlickByteQueueTests, MessagesDoNotStraddleTheEnd) {
+  SlickByteQueue<16> queue(256);
+  std::vector<std::byte> payload(40, std::byte{ 7 });
+  uint64_t read_cursor = 0;
+  for (int i = 0; i < 20; ++i) {
+    payload[0] = static_cast<std::byte>(i);
+    queue.push(payload);
+    auto read = queue.read(read_cursor);
+    ASSERT_EQ(read.size(), 40u);
+    EXPECT_EQ(read[0], static_cast<std::byte>(i));
+    EXPECT_EQ(read[39], std::byte{ 7 });
+  }
+}
+
+TEST(SlickByteQueueTests, SharedCursorHandsOutEachMessageOnce) {
+  SlickByteQueue<> queue(1024);
+  std::vector<byte_claim> claims;
+  for (uint32_t length = 1; length <= 10; ++length) {
+    claims.push_back(queue.claim(length * 10));
+  }
+  for (auto& claim : claims) {
+    queue.commit(claim);
+  }
+  std::atomic<uint64_t> cursor{ 0 };
+  uint32_t messages = 0;
+  while (!queue.read(cursor).empty()) {
+    ++messages;
+  }
+  EXPECT_EQ(messages, 10u);
+}
+
+TEST(SlickByteQueueTests, RejectsInvalidLengths) {
+  EXPECT_THROW(SlickByteQueue<>(1000), std::invalid_argument);
+  SlickByteQueue<> queue(64);
+  EXPECT_EQ(queue.max_message_size(), 56u);
+  EXPECT_THROW(queue.claim(0), std::invalid_argument);
+  EXPECT_THROW(queue.claim(57), std::runtime_error);
+  EXPECT_EQ(queue.claim(56).data.size(), 56u);
+}
+
+#if defined(__linux__)
+TEST(SlickByteQueueTests, MirroredUsesTheTailChunks) {
+  SlickByteQueue<64> queue(4096, queue_options{ .mirrored = true });
+  std::vector<std::byte> payload(300, std::byte{ 3 });
+  uint64_t read_cursor = 0;
+  uint64_t expected = 0;
+  for (int i = 0; i < 50; ++i) {
+    // 5 chunks per message, a plain ring would skip to the start on every lap
+    EXPECT_EQ(queue.push(payload), expected);
+    expected += 5;
+    auto read = queue.read(read_cursor);
+    ASSERT_EQ(read.size(), 300u);
+    EXPECT_EQ(read[299], std::byte{ 3 });
+  }
+}
+#endif